@@ -0,0 +1,19 @@
+#type vertex
+#version 330 core
+precision mediump float;
+layout(location = 0) in vec3 in_Position;
+#include "include/camera.glsl"
+#include "include/transforms.glsl"
+#include "include/object.glsl"
+invariant gl_Position;
+
+void main() {
+    gl_Position = getClipPosition(getModelMatrix(), in_Position);
+}
+
+#type fragment
+#version 330 core
+precision mediump float;
+
+void main() {
+}
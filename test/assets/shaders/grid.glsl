@@ -1,42 +1,76 @@
 #type vertex
 #version 330 core
-#extension GL_ARB_explicit_uniform_location : require
 precision mediump float;
-layout(location = 0) in vec3 in_Position;
-layout(location = 1) in vec3 in_Normal;
-layout(location = 2) in vec2 in_Uv;
-layout(location = 0) uniform mat4 u_Projection;
-layout(location = 1) uniform mat4 u_View;
-layout(location = 2) uniform vec3 u_CameraPosition;
-out vec3 v_Normal;
-out vec2 v_Uv;
+#include "include/camera.glsl"
+out vec3 v_Near;
+out vec3 v_Far;
 
+vec3 unproject(mat4 inverseViewProjection, vec2 position, float depth) {
+    vec4 world = inverseViewProjection * vec4(position, depth, 1.0);
+
+    return world.xyz / world.w;
+}
+
+// One triangle covering the screen, each pixel then finds its own ray through the ground plane
 void main() {
-    mat4 translation = mat4(1.0);
-    translation[0][0] = 1000.0;
-    translation[2][2] = 1000.0;
-    // translation[3] = vec4(u_CameraPosition.x, 0, u_CameraPosition.z, 1.0);
-    gl_Position = u_Projection * u_View * translation * vec4(in_Position, 1);
-    v_Uv = in_Uv;
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;
+    mat4 inverseViewProjection = inverse(u_Projection * u_View);
+    v_Near = unproject(inverseViewProjection, position, -1.0);
+    v_Far = unproject(inverseViewProjection, position, 1.0);
+    gl_Position = vec4(position, 0.0, 1.0);
 }
 
 #type fragment
 #version 330 core
-#extension GL_ARB_explicit_uniform_location : require
 precision mediump float;
-in vec2 v_Uv;
-layout(location = 3) uniform vec3 u_Color;
+#include "include/camera.glsl"
+layout(std140) uniform Grid {
+    vec4 u_Color;
+    vec4 u_Parameters;
+};
+in vec3 v_Near;
+in vec3 v_Far;
 out vec4 FragColor;
 
+// Line coverage in pixels from screen derivatives, so lines stay one pixel wide at any distance
+float getGridLines(vec2 coordinate, float spacing) {
+    vec2 scaled = coordinate / spacing;
+    vec2 lines = abs(fract(scaled - 0.5) - 0.5) / fwidth(scaled);
+
+    return 1.0 - min(min(lines.x, lines.y), 1.0);
+}
+
 void main() {
-    bool x = mod(v_Uv.x * 1000, 0.5) < 0.01;
-    bool y = mod(v_Uv.y * 1000, 0.5) < 0.01;
-    bool xAxis = step(0.5 - 0.00002, v_Uv.x) > 0 && step(v_Uv.x, 0.5 + 0.00002) > 0;
-    bool zAxis = step(0.5 - 0.00002, v_Uv.y) > 0 && step(v_Uv.y, 0.5 + 0.00002) > 0;
+    float t = -v_Near.y / (v_Far.y - v_Near.y);
+    vec3 position = v_Near + t * (v_Far - v_Near);
+    float distance = length(position.xz - u_CameraPosition.xz);
+    float fadeRadius = u_Parameters.y;
+
+    // Derivatives are taken before any discard, where the whole quad is still running
+    float spacing = u_Parameters.x;
+    float fine = getGridLines(position.xz, spacing) * (1.0 - smoothstep(0.0, fadeRadius * 0.25, distance));
+    float coarse = getGridLines(position.xz, spacing * 10.0);
+    vec2 axisWidth = fwidth(position.xz);
+
+    // Above the horizon or past the fade radius nothing is shaded
+    if (t <= 0.0 || distance > fadeRadius) {
+        discard;
+    }
+
+    vec4 clip = u_Projection * u_View * vec4(position, 1.0);
+    gl_FragDepth = clip.z / clip.w * 0.5 + 0.5;
+
+    float fade = 1.0 - smoothstep(fadeRadius * 0.5, fadeRadius, distance);
+    bool xAxis = abs(position.z) < axisWidth.y;
+    bool zAxis = abs(position.x) < axisWidth.x;
 
     if (xAxis || zAxis) {
-        FragColor = vec4(float(xAxis), 0.0, float(zAxis), 1.0);
+        FragColor = vec4(float(xAxis), 0.0, float(zAxis), fade);
     } else {
-        FragColor = vec4(u_Color.x, u_Color.y, u_Color.z, x || y);
+        FragColor = vec4(u_Color.xyz, max(fine, coarse) * fade);
+    }
+
+    if (FragColor.a <= 0.0) {
+        discard;
     }
 }
@@ -0,0 +1,70 @@
+#type vertex
+#version 330 core
+precision mediump float;
+#include "include/camera.glsl"
+#include "include/transforms.glsl"
+#include "include/octahedral.glsl"
+layout(std140) uniform Impostor {
+    vec4 u_Bounds;
+    vec4 u_Grid;
+};
+layout(location = 0) in uint in_Slot;
+out vec3 v_Position;
+out vec3 v_ViewPosition;
+out vec2 v_Uv;
+
+// Four vertices per instance, the only per-instance input is the transform slot
+void main() {
+    mat4 model = getTransform(int(in_Slot));
+    vec3 center = u_Bounds.xyz;
+    float gridSize = u_Grid.x;
+
+    // The baked view closest to the camera in object space, the quad then faces exactly that view so the image lines up
+    vec3 camera = (inverse(model) * vec4(u_CameraPosition.xyz, 1.0)).xyz;
+    vec2 cell = clamp(floor((encodeOctahedral(normalize(camera - center)) * 0.5 + 0.5) * gridSize), 0.0, gridSize - 1.0);
+    vec3 direction = decodeOctahedral((cell + 0.5) / gridSize * 2.0 - 1.0);
+    vec3 up = abs(direction.y) > 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0);
+    vec3 right = normalize(cross(-direction, up));
+    up = cross(right, -direction);
+
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    vec4 position = model * vec4(center + (right * corner.x + up * corner.y) * u_Bounds.w, 1.0);
+    vec4 viewPosition = u_View * position;
+    gl_Position = u_Projection * viewPosition;
+    v_Position = position.xyz;
+    v_ViewPosition = viewPosition.xyz;
+    v_Uv = (cell + corner * 0.5 + 0.5) / gridSize;
+}
+
+#type fragment
+#version 330 core
+precision mediump float;
+#include "include/lighting.glsl"
+in vec3 v_Position;
+in vec3 v_ViewPosition;
+in vec2 v_Uv;
+uniform sampler2D u_ImpostorColor;
+uniform sampler2D u_ImpostorNormal;
+out vec4 FragColor;
+
+void main() {
+    vec4 color = texture(u_ImpostorColor, v_Uv);
+
+    // Coverage was baked into alpha, the silhouette comes from the atlas rather than the quad
+    if (color.a < 0.5) {
+        discard;
+    }
+
+    vec3 normal = normalize(texture(u_ImpostorNormal, v_Uv).xyz * 2.0 - 1.0);
+    vec3 lighting = vec3(0.0);
+
+#ifdef FEATURE_SUN_LIGHT
+    lighting += getSunLighting(normal);
+#endif
+
+#ifdef FEATURE_CLUSTERED_LIGHTS
+    lighting += getClusterLighting(v_Position, v_ViewPosition, normal);
+#endif
+
+    FragColor = vec4(color.rgb * lighting, 1.0);
+}
@@ -0,0 +1,31 @@
+#type vertex
+#version 330 core
+precision mediump float;
+layout(location = 0) in vec3 in_Position;
+layout(location = 1) in vec3 in_Normal;
+layout(location = 2) in vec2 in_Uv;
+uniform mat4 u_ViewProjection;
+out vec3 v_Normal;
+out vec2 v_Uv;
+
+// Object space throughout, the atlas is shared by every instance of the model
+void main() {
+    gl_Position = u_ViewProjection * vec4(in_Position, 1.0);
+    v_Normal = in_Normal;
+    v_Uv = in_Uv;
+}
+
+#type fragment
+#version 330 core
+precision mediump float;
+in vec3 v_Normal;
+in vec2 v_Uv;
+uniform sampler2DArray u_Texture;
+uniform float u_Layer;
+layout(location = 0) out vec4 Color;
+layout(location = 1) out vec4 Normal;
+
+void main() {
+    Color = vec4(texture(u_Texture, vec3(v_Uv, u_Layer)).rgb, 1.0);
+    Normal = vec4(normalize(v_Normal) * 0.5 + 0.5, 1.0);
+}
@@ -0,0 +1,12 @@
+layout(std140) uniform Camera {
+    mat4 u_Projection;
+    mat4 u_View;
+    vec4 u_CameraPosition;
+    vec4 u_ClusterCount;
+    vec4 u_ClusterDepth;
+};
+
+// Every pass drawing the same geometry goes through this, invariant only holds for identical expressions
+vec4 getClipPosition(mat4 model, vec3 position) {
+    return u_Projection * u_View * model * vec4(position, 1);
+}
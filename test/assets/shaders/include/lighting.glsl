@@ -0,0 +1,33 @@
+#include "camera.glsl"
+uniform samplerBuffer u_Lights;
+uniform usamplerBuffer u_LightClusters;
+uniform usamplerBuffer u_LightIndices;
+
+vec3 sunColor = vec3(1.0, 0.0, 0.0);
+vec3 sunPosition = vec3(1.0, 1.0, 1.0);
+
+vec3 getSunLighting(vec3 normal) {
+    return max(dot(normal, normalize(sunPosition)), 0.0) * sunColor;
+}
+
+// Only the lights binned into this fragment's cluster are visited
+vec3 getClusterLighting(vec3 position, vec3 viewPosition, vec3 normal) {
+    vec4 clip = u_Projection * vec4(viewPosition, 1.0);
+    ivec2 tile = clamp(ivec2((clip.xy / clip.w * 0.5 + 0.5) * u_ClusterCount.xy), ivec2(0), ivec2(u_ClusterCount.xy) - 1);
+    int slice = clamp(int(log(-viewPosition.z) * u_ClusterDepth.x - u_ClusterDepth.y), 0, int(u_ClusterCount.z) - 1);
+    int cluster = tile.x + int(u_ClusterCount.x) * (tile.y + int(u_ClusterCount.y) * slice);
+    uvec2 range = texelFetch(u_LightClusters, cluster).xy;
+    vec3 color = vec3(0.0);
+
+    for (uint a = 0u; a < range.y; ++a) {
+        int light = int(texelFetch(u_LightIndices, int(range.x + a)).x);
+        vec4 positionRadius = texelFetch(u_Lights, light * 2);
+        vec4 colorIntensity = texelFetch(u_Lights, light * 2 + 1);
+        vec3 delta = positionRadius.xyz - position;
+        float distance = length(delta);
+        float attenuation = clamp(1.0 - distance / positionRadius.w, 0.0, 1.0);
+        color += colorIntensity.rgb * colorIntensity.a * attenuation * attenuation * max(dot(normal, delta / max(distance, 0.0001)), 0.0);
+    }
+
+    return color;
+}
@@ -0,0 +1,8 @@
+layout(std140) uniform Object {
+    vec4 u_Material;
+};
+
+// u_Material.y is the transform slot of this object
+mat4 getModelMatrix() {
+    return getTransform(int(u_Material.y));
+}
@@ -0,0 +1,20 @@
+// Unit directions folded onto a square, the upper hemisphere is the inner diamond. Mirrored by impostors.cpp
+vec2 encodeOctahedral(vec3 direction) {
+    direction /= abs(direction.x) + abs(direction.y) + abs(direction.z);
+
+    if (direction.y >= 0.0) {
+        return direction.xz;
+    }
+
+    return (1.0 - abs(direction.zx)) * vec2(direction.x >= 0.0 ? 1.0 : -1.0, direction.z >= 0.0 ? 1.0 : -1.0);
+}
+
+vec3 decodeOctahedral(vec2 coordinate) {
+    vec3 direction = vec3(coordinate.x, 1.0 - abs(coordinate.x) - abs(coordinate.y), coordinate.y);
+
+    if (direction.y < 0.0) {
+        direction.xz = (1.0 - abs(direction.zx)) * vec2(direction.x >= 0.0 ? 1.0 : -1.0, direction.z >= 0.0 ? 1.0 : -1.0);
+    }
+
+    return normalize(direction);
+}
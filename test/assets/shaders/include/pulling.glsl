@@ -0,0 +1,53 @@
+// Raw bytes of every pulled mesh, decoded here instead of by a vertex array
+layout(std430, binding = 0) readonly buffer PulledVertices {
+    uint b_Vertices[];
+};
+// Per mesh: byte offsets, strides and component types of position, normal and uv
+layout(std430, binding = 1) readonly buffer PulledLayouts {
+    uvec4 b_Layouts[];
+};
+// One per draw through the base instance: layout, transform slot, texture layer
+layout(location = 3) in uvec4 in_Draw;
+
+const uint PULLED_POSITION = 0u;
+const uint PULLED_NORMAL = 1u;
+const uint PULLED_UV = 2u;
+
+float pullComponent(uint offset, uint type) {
+    uint word = b_Vertices[offset >> 2];
+    uint format = type & 0xffffu;
+    bool isNormalized = (type >> 16) != 0u;
+
+    if (format == 5126u) {
+        return uintBitsToFloat(word);
+    }
+
+    uint bits = (offset & 2u) != 0u ? word >> 16 : word & 0xffffu;
+
+    if (format == 5123u) {
+        return isNormalized ? float(bits) / 65535.0 : float(bits);
+    }
+
+    float value = float(int(bits << 16) >> 16);
+
+    return isNormalized ? max(value / 32767.0, -1.0) : value;
+}
+
+vec4 pullAttribute(uint attribute, uint count) {
+    uint mesh = in_Draw.x * 3u;
+    uint type = b_Layouts[mesh + 2u][attribute];
+    vec4 value = vec4(0.0, 0.0, 0.0, 1.0);
+
+    if (type == 0u) {
+        return value;
+    }
+
+    uint size = (type & 0xffffu) == 5126u ? 4u : 2u;
+    uint offset = b_Layouts[mesh][attribute] + uint(gl_VertexID) * b_Layouts[mesh + 1u][attribute];
+
+    for (uint a = 0u; a < count; ++a) {
+        value[a] = pullComponent(offset + a * size, type);
+    }
+
+    return value;
+}
@@ -0,0 +1,8 @@
+uniform samplerBuffer u_Transforms;
+
+// Model matrices live in a persistent buffer, four texels per slot
+mat4 getTransform(int slot) {
+    int row = slot * 4;
+
+    return mat4(texelFetch(u_Transforms, row), texelFetch(u_Transforms, row + 1), texelFetch(u_Transforms, row + 2), texelFetch(u_Transforms, row + 3));
+}
@@ -1,36 +1,79 @@
 #type vertex
 #version 330 core
-#extension GL_ARB_explicit_uniform_location : require
+#ifdef FEATURE_VERTEX_PULLING
+#extension GL_ARB_shader_storage_buffer_object : require
+#extension GL_ARB_shading_language_420pack : require
+#endif
 precision mediump float;
+#include "include/camera.glsl"
+#include "include/transforms.glsl"
+#ifdef FEATURE_VERTEX_PULLING
+#include "include/pulling.glsl"
+#else
 layout(location = 0) in vec3 in_Position;
 layout(location = 1) in vec3 in_Normal;
 layout(location = 2) in vec2 in_Uv;
-layout(location = 0) uniform mat4 u_Projection;
-layout(location = 1) uniform mat4 u_View;
-layout(location = 2) uniform mat4 u_Model;
+#include "include/object.glsl"
+#endif
+out vec3 v_Position;
+out vec3 v_ViewPosition;
 out vec3 v_Normal;
 out vec2 v_Uv;
+flat out float v_Layer;
+invariant gl_Position;
 
 void main() {
-    gl_Position = u_Projection * u_View * u_Model * vec4(in_Position, 1);
-    v_Normal = in_Normal;
-    v_Uv = in_Uv;
+#ifdef FEATURE_VERTEX_PULLING
+    vec3 inPosition = pullAttribute(PULLED_POSITION, 3u).xyz;
+    vec3 inNormal = pullAttribute(PULLED_NORMAL, 3u).xyz;
+    vec2 inUv = pullAttribute(PULLED_UV, 2u).xy;
+    mat4 model = getTransform(int(in_Draw.y));
+    float layer = float(in_Draw.z);
+#else
+    vec3 inPosition = in_Position;
+    vec3 inNormal = in_Normal;
+    vec2 inUv = in_Uv;
+    mat4 model = getModelMatrix();
+    float layer = u_Material.x;
+#endif
+
+    vec4 position = model * vec4(inPosition, 1);
+    gl_Position = getClipPosition(model, inPosition);
+    v_Position = position.xyz;
+    v_ViewPosition = (u_View * position).xyz;
+    v_Normal = inNormal;
+    v_Uv = inUv;
+    v_Layer = layer;
 }
 
 #type fragment
 #version 330 core
 precision mediump float;
+#include "include/lighting.glsl"
+in vec3 v_Position;
+in vec3 v_ViewPosition;
 in vec2 v_Uv;
 in vec3 v_Normal;
-uniform sampler2D u_Texture;
+flat in float v_Layer;
+uniform sampler2DArray u_Texture;
 out vec4 FragColor;
 
-vec3 sunColor = vec3(1.0, 0.0, 0.0);
-vec3 sunPosition = vec3(1.0, 1.0, 1.0);
+void main() {
+    vec3 lighting = vec3(0.0);
+    vec4 color = vec4(1.0);
 
+#ifdef FEATURE_SUN_LIGHT
+    lighting += getSunLighting(v_Normal);
+#endif
 
-void main() {
-    float lum = max(dot(v_Normal, normalize(sunPosition)), 0.0);
-    FragColor = texture2D(u_Texture, v_Uv) * vec4((lum) * sunColor, 1.0);
+#ifdef FEATURE_CLUSTERED_LIGHTS
+    lighting += getClusterLighting(v_Position, v_ViewPosition, normalize(v_Normal));
+#endif
+
+#ifdef FEATURE_TEXTURED
+    color = texture(u_Texture, vec3(v_Uv, v_Layer));
+#endif
+
+    FragColor = color * vec4(lighting, 1.0);
     // FragColor = vec4(1.0, 1.0, 1.0, 1.0);
 }
@@ -0,0 +1,86 @@
+#include "../preprocessor.hpp"
+#include <chrono>
+#include <regex>
+
+// The splitter loadShaderProgram used before the preprocessor, kept only to compare against
+std::map<std::string, std::string> splitShaderProgram(const std::string &path) {
+    std::ifstream shaderProgramFile(path);
+    std::string line;
+    std::string type;
+    std::string source;
+    std::map<std::string, std::string> typeSourceMap;
+
+    while (std::getline(shaderProgramFile, line)) {
+        std::cmatch matches;
+
+        if (std::regex_match(line.c_str(), matches, std::regex("#type ([a-z]{6,8})"))) {
+            if (type.empty()) {
+                type = matches[1];
+            } else {
+                if (type != matches[1]) {
+                    typeSourceMap.insert({ type, source });
+                    type = matches[1];
+                    source = "";
+                }
+            }
+        } else {
+            if (!type.empty()) {
+                source += line + "\n";
+            }
+        }
+    }
+
+    typeSourceMap.insert({ type, source });
+
+    return typeSourceMap;
+}
+
+template <typename Function>
+double measure(int iterations, Function function) {
+    auto start = std::chrono::steady_clock::now();
+
+    for (int a = 0; a < iterations; ++a) {
+        function();
+    }
+
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+int main(int argc, char* argv[]) {
+    std::string directory = argc > 1 ? argv[1] : "../assets/shaders/";
+    int iterations = argc > 2 ? std::stoi(argv[2]) : 1000;
+    ShaderDefines defines = { { "MAX_LIGHTS", "128" } };
+    size_t checksum = 0;
+
+    for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+        if (entry.path().extension() != ".glsl") {
+            continue;
+        }
+
+        std::string path = entry.path().string();
+
+        double regexTime = measure(iterations, [&]() {
+            checksum += splitShaderProgram(path).size();
+        });
+
+        // Cold reads the file every time like the old path, warm shares the file cache like repeated variants do
+        double coldTime = measure(iterations, [&]() {
+            ShaderFiles files;
+            PreprocessedShader shader;
+            preprocessShader(shader, files, path, defines);
+            checksum += shader.stages.size();
+        });
+
+        ShaderFiles files;
+
+        double warmTime = measure(iterations, [&]() {
+            PreprocessedShader shader;
+            preprocessShader(shader, files, path, defines);
+            checksum += shader.stages.size();
+        });
+
+        std::cout << entry.path().filename().string() << ": regex " << regexTime << " us, preprocessor " << coldTime << " us, cached " << warmTime << " us (" << regexTime / coldTime << "x)" << std::endl;
+    }
+
+    return checksum == 0;
+}
@@ -0,0 +1,86 @@
+#include "commands.hpp"
+
+void clearCommands(CommandBuffer &commandBuffer) {
+    commandBuffer.commands.clear();
+}
+
+void recordCommand(CommandBuffer &commandBuffer, CommandType type, uint32_t value, uint32_t parameter = 0, uint32_t count = 0, uint64_t offset = 0, uint64_t size = 0) {
+    commandBuffer.commands.push_back({ type, value, parameter, count, offset, size });
+}
+
+void recordUseProgram(CommandBuffer &commandBuffer, uint32_t program) {
+    recordCommand(commandBuffer, CommandType::UseProgram, program);
+}
+
+void recordBindVertexArray(CommandBuffer &commandBuffer, uint32_t vertexArray) {
+    recordCommand(commandBuffer, CommandType::BindVertexArray, vertexArray);
+}
+
+void recordBindUniforms(CommandBuffer &commandBuffer, uint32_t binding, uint32_t buffer, uint64_t offset, uint64_t size) {
+    recordCommand(commandBuffer, CommandType::BindUniforms, buffer, binding, 0, offset, size);
+}
+
+void recordBindTexture(CommandBuffer &commandBuffer, uint32_t unit, uint32_t target, uint32_t texture) {
+    recordCommand(commandBuffer, CommandType::BindTexture, texture, unit, target);
+}
+
+void recordSetCapability(CommandBuffer &commandBuffer, uint32_t capability, bool isEnabled) {
+    recordCommand(commandBuffer, CommandType::SetCapability, capability, isEnabled);
+}
+
+void recordSetDepthFunc(CommandBuffer &commandBuffer, uint32_t function) {
+    recordCommand(commandBuffer, CommandType::SetDepthFunc, function);
+}
+
+void recordSetDepthMask(CommandBuffer &commandBuffer, bool isEnabled) {
+    recordCommand(commandBuffer, CommandType::SetDepthMask, isEnabled);
+}
+
+void recordSetBlendFunc(CommandBuffer &commandBuffer, uint32_t source, uint32_t destination) {
+    recordCommand(commandBuffer, CommandType::SetBlendFunc, source, destination);
+}
+
+void recordDrawArrays(CommandBuffer &commandBuffer, uint32_t first, uint32_t count) {
+    recordCommand(commandBuffer, CommandType::DrawArrays, first, 0, count);
+}
+
+void recordDrawElements(CommandBuffer &commandBuffer, uint32_t count, uint32_t indexType, uint64_t offset) {
+    recordCommand(commandBuffer, CommandType::DrawElements, 0, indexType, count, offset);
+}
+
+void submitCommands(GlState &state, const CommandBuffer &commandBuffer) {
+    for (auto &command : commandBuffer.commands) {
+        switch (command.type) {
+            case CommandType::UseProgram:
+                useProgram(state, command.value);
+                break;
+            case CommandType::BindVertexArray:
+                bindVertexArray(state, command.value);
+                break;
+            case CommandType::BindUniforms:
+                bindBufferRange(state, GL_UNIFORM_BUFFER, command.parameter, command.value, (GLintptr) command.offset, (GLsizeiptr) command.size);
+                break;
+            case CommandType::BindTexture:
+                bindTexture(state, command.parameter, command.count, command.value);
+                break;
+            case CommandType::SetCapability:
+                setCapability(state, command.value, command.parameter);
+                break;
+            case CommandType::SetDepthFunc:
+                setDepthFunc(state, command.value);
+                break;
+            case CommandType::SetDepthMask:
+                setDepthMask(state, command.value);
+                break;
+            case CommandType::SetBlendFunc:
+                setBlendFunc(state, command.value, command.parameter);
+                break;
+            case CommandType::DrawArrays:
+                glDrawArrays(GL_TRIANGLES, command.value, command.count);
+                break;
+            case CommandType::DrawElements:
+                glDrawElements(GL_TRIANGLES, command.count, command.parameter, (const void*) (uintptr_t) command.offset);
+                break;
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "state.hpp"
+#include <cstdint>
+#include <vector>
+
+enum class CommandType : uint8_t {
+    UseProgram,
+    BindVertexArray,
+    BindUniforms,
+    BindTexture,
+    SetCapability,
+    SetDepthFunc,
+    SetDepthMask,
+    SetBlendFunc,
+    DrawArrays,
+    DrawElements
+};
+
+// Plain data only, recording never touches GL so it can happen on any thread
+struct Command {
+    CommandType type;
+    uint32_t value;
+    uint32_t parameter;
+    uint32_t count;
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct CommandBuffer {
+    std::vector<Command> commands;
+};
+
+void clearCommands(CommandBuffer &commandBuffer);
+
+void recordUseProgram(CommandBuffer &commandBuffer, uint32_t program);
+
+void recordBindVertexArray(CommandBuffer &commandBuffer, uint32_t vertexArray);
+
+void recordBindUniforms(CommandBuffer &commandBuffer, uint32_t binding, uint32_t buffer, uint64_t offset, uint64_t size);
+
+void recordBindTexture(CommandBuffer &commandBuffer, uint32_t unit, uint32_t target, uint32_t texture);
+
+void recordSetCapability(CommandBuffer &commandBuffer, uint32_t capability, bool isEnabled);
+
+void recordSetDepthFunc(CommandBuffer &commandBuffer, uint32_t function);
+
+void recordSetDepthMask(CommandBuffer &commandBuffer, bool isEnabled);
+
+void recordSetBlendFunc(CommandBuffer &commandBuffer, uint32_t source, uint32_t destination);
+
+void recordDrawArrays(CommandBuffer &commandBuffer, uint32_t first, uint32_t count);
+
+void recordDrawElements(CommandBuffer &commandBuffer, uint32_t count, uint32_t indexType, uint64_t offset);
+
+void submitCommands(GlState &state, const CommandBuffer &commandBuffer);
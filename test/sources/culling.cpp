@@ -0,0 +1,265 @@
+#include "culling.hpp"
+
+void clearOcclusion(Occlusion &occlusion) {
+    occlusion.triangles.clear();
+    occlusion.testedCount = 0;
+    occlusion.culledCount = 0;
+
+    // Hierarchical-Z chain, level 0 is the rasterized depth and every next level keeps the farthest depth of 2x2 texels
+    if (occlusion.levelSizes.empty() || occlusion.levelSizes[0] != occlusion.size) {
+        occlusion.levels.clear();
+        occlusion.levelSizes.clear();
+        glm::ivec2 levelSize = occlusion.size;
+
+        while (true) {
+            occlusion.levelSizes.push_back(levelSize);
+            occlusion.levels.push_back(std::vector<float>(levelSize.x * levelSize.y));
+
+            if (levelSize.x == 1 && levelSize.y == 1) {
+                break;
+            }
+
+            levelSize = glm::ivec2((levelSize.x + 1) / 2, (levelSize.y + 1) / 2);
+        }
+    }
+
+    std::fill(occlusion.levels[0].begin(), occlusion.levels[0].end(), 1.0f);
+}
+
+glm::vec3 projectToScreen(const Occlusion &occlusion, const glm::vec4 &clip) {
+    glm::vec3 ndc = glm::vec3(clip.x, clip.y, clip.z) / clip.w;
+
+    return glm::vec3(
+        (ndc.x * 0.5f + 0.5f) * occlusion.size.x,
+        (0.5f - ndc.y * 0.5f) * occlusion.size.y,
+        ndc.z * 0.5f + 0.5f
+    );
+}
+
+void addOccluder(Occlusion &occlusion, const glm::mat4 &modelViewProjection, const OccluderMesh &mesh) {
+    std::vector<glm::vec4> clips;
+    clips.reserve(mesh.positions.size());
+
+    for (auto &position : mesh.positions) {
+        clips.push_back(modelViewProjection * glm::vec4(position, 1.0f));
+    }
+
+    occlusion.triangles.reserve(occlusion.triangles.size() + mesh.indices.size() / 3);
+
+    for (size_t a = 0; a + 2 < mesh.indices.size(); a += 3) {
+        const glm::vec4 &clipA = clips[mesh.indices[a]];
+        const glm::vec4 &clipB = clips[mesh.indices[a + 1]];
+        const glm::vec4 &clipC = clips[mesh.indices[a + 2]];
+
+        // Triangles crossing the near plane are skipped, dropping occluders only makes culling more conservative
+        if (clipA.w <= 1e-4f || clipB.w <= 1e-4f || clipC.w <= 1e-4f || clipA.z < -clipA.w || clipB.z < -clipB.w || clipC.z < -clipC.w) {
+            continue;
+        }
+
+        occlusion.triangles.push_back({
+            projectToScreen(occlusion, clipA),
+            projectToScreen(occlusion, clipB),
+            projectToScreen(occlusion, clipC)
+        });
+    }
+}
+
+float getEdge(const glm::vec3 &from, const glm::vec3 &to, float x, float y) {
+    return (to.x - from.x) * (y - from.y) - (to.y - from.y) * (x - from.x);
+}
+
+void rasterizeTriangle(Occlusion &occlusion, ScreenTriangle triangle, int bandStart, int bandEnd) {
+    float area = getEdge(triangle.a, triangle.b, triangle.c.x, triangle.c.y);
+
+    if (std::abs(area) < 1e-6f) {
+        return;
+    }
+
+    if (area < 0.0f) {
+        std::swap(triangle.b, triangle.c);
+        area = -area;
+    }
+
+    const glm::vec3 &a = triangle.a;
+    const glm::vec3 &b = triangle.b;
+    const glm::vec3 &c = triangle.c;
+
+    int width = occlusion.size.x;
+    int minX = std::max((int) std::floor(std::min({ a.x, b.x, c.x })), 0);
+    int maxX = std::min((int) std::ceil(std::max({ a.x, b.x, c.x })), width - 1);
+    int minY = std::max((int) std::floor(std::min({ a.y, b.y, c.y })), bandStart);
+    int maxY = std::min((int) std::ceil(std::max({ a.y, b.y, c.y })), bandEnd - 1);
+
+    if (minX > maxX || minY > maxY) {
+        return;
+    }
+
+    // Edge functions and depth are linear in screen space, so they are stepped instead of re-evaluated per pixel
+    float inverseArea = 1.0f / area;
+    float stepX0 = -(c.y - b.y);
+    float stepX1 = -(a.y - c.y);
+    float stepX2 = -(b.y - a.y);
+    float depthStepX = (stepX0 * a.z + stepX1 * b.z + stepX2 * c.z) * inverseArea;
+    minX &= ~3;
+
+    for (int y = minY; y <= maxY; ++y) {
+        float pixelX = minX + 0.5f;
+        float pixelY = y + 0.5f;
+        float edge0 = getEdge(b, c, pixelX, pixelY);
+        float edge1 = getEdge(c, a, pixelX, pixelY);
+        float edge2 = getEdge(a, b, pixelX, pixelY);
+        float depth = (edge0 * a.z + edge1 * b.z + edge2 * c.z) * inverseArea;
+        float* row = &occlusion.levels[0][y * width];
+        int x = minX;
+
+#if defined(__SSE2__)
+        const __m128 lanes = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+        const __m128 zero = _mm_setzero_ps();
+        __m128 edges0 = _mm_add_ps(_mm_set1_ps(edge0), _mm_mul_ps(lanes, _mm_set1_ps(stepX0)));
+        __m128 edges1 = _mm_add_ps(_mm_set1_ps(edge1), _mm_mul_ps(lanes, _mm_set1_ps(stepX1)));
+        __m128 edges2 = _mm_add_ps(_mm_set1_ps(edge2), _mm_mul_ps(lanes, _mm_set1_ps(stepX2)));
+        __m128 depths = _mm_add_ps(_mm_set1_ps(depth), _mm_mul_ps(lanes, _mm_set1_ps(depthStepX)));
+        const __m128 stepEdges0 = _mm_set1_ps(stepX0 * 4.0f);
+        const __m128 stepEdges1 = _mm_set1_ps(stepX1 * 4.0f);
+        const __m128 stepEdges2 = _mm_set1_ps(stepX2 * 4.0f);
+        const __m128 stepDepths = _mm_set1_ps(depthStepX * 4.0f);
+
+        for (; x + 3 < width && x <= maxX; x += 4) {
+            __m128 mask = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edges0, zero), _mm_cmpge_ps(edges1, zero)), _mm_cmpge_ps(edges2, zero));
+
+            if (_mm_movemask_ps(mask)) {
+                __m128 previous = _mm_loadu_ps(row + x);
+                __m128 nearest = _mm_min_ps(previous, depths);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(mask, nearest), _mm_andnot_ps(mask, previous)));
+            }
+
+            edges0 = _mm_add_ps(edges0, stepEdges0);
+            edges1 = _mm_add_ps(edges1, stepEdges1);
+            edges2 = _mm_add_ps(edges2, stepEdges2);
+            depths = _mm_add_ps(depths, stepDepths);
+        }
+
+        float steps = (float) (x - minX);
+        edge0 += stepX0 * steps;
+        edge1 += stepX1 * steps;
+        edge2 += stepX2 * steps;
+        depth += depthStepX * steps;
+#endif
+
+        for (; x <= maxX; ++x) {
+            if (edge0 >= 0.0f && edge1 >= 0.0f && edge2 >= 0.0f) {
+                row[x] = std::min(row[x], depth);
+            }
+
+            edge0 += stepX0;
+            edge1 += stepX1;
+            edge2 += stepX2;
+            depth += depthStepX;
+        }
+    }
+}
+
+void buildHierarchicalDepth(Occlusion &occlusion) {
+    for (size_t level = 1; level < occlusion.levels.size(); ++level) {
+        const std::vector<float> &source = occlusion.levels[level - 1];
+        const glm::ivec2 &sourceSize = occlusion.levelSizes[level - 1];
+        std::vector<float> &target = occlusion.levels[level];
+        const glm::ivec2 &targetSize = occlusion.levelSizes[level];
+
+        for (int y = 0; y < targetSize.y; ++y) {
+            int y0 = std::min(y * 2, sourceSize.y - 1);
+            int y1 = std::min(y * 2 + 1, sourceSize.y - 1);
+
+            for (int x = 0; x < targetSize.x; ++x) {
+                int x0 = std::min(x * 2, sourceSize.x - 1);
+                int x1 = std::min(x * 2 + 1, sourceSize.x - 1);
+
+                target[y * targetSize.x + x] = std::max(
+                    std::max(source[y0 * sourceSize.x + x0], source[y0 * sourceSize.x + x1]),
+                    std::max(source[y1 * sourceSize.x + x0], source[y1 * sourceSize.x + x1])
+                );
+            }
+        }
+    }
+}
+
+void rasterizeOcclusion(Occlusion &occlusion, Jobs &jobs) {
+    // Every worker owns a band of rows, so no two workers ever write the same texel
+    int bandCount = (occlusion.size.y + occlusion.bandHeight - 1) / occlusion.bandHeight;
+
+    parallelFor(jobs, bandCount, [&occlusion](int begin, int end) {
+        for (int band = begin; band < end; ++band) {
+            int bandStart = band * occlusion.bandHeight;
+            int bandEnd = std::min(bandStart + occlusion.bandHeight, occlusion.size.y);
+
+            for (auto &triangle : occlusion.triangles) {
+                rasterizeTriangle(occlusion, triangle, bandStart, bandEnd);
+            }
+        }
+    });
+
+    buildHierarchicalDepth(occlusion);
+}
+
+bool isOccluded(Occlusion &occlusion, const glm::mat4 &modelViewProjection, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax) {
+    occlusion.testedCount++;
+
+    glm::vec2 screenMin = glm::vec2(INFINITY, INFINITY);
+    glm::vec2 screenMax = glm::vec2(-INFINITY, -INFINITY);
+    float nearestDepth = INFINITY;
+
+    for (int a = 0; a < 8; ++a) {
+        glm::vec3 corner = glm::vec3(
+            a & 1 ? boundsMax.x : boundsMin.x,
+            a & 2 ? boundsMax.y : boundsMin.y,
+            a & 4 ? boundsMax.z : boundsMin.z
+        );
+        glm::vec4 clip = modelViewProjection * glm::vec4(corner, 1.0f);
+
+        // Bounds crossing the near plane can't be projected reliably
+        if (clip.w <= 1e-4f) {
+            return false;
+        }
+
+        glm::vec3 screen = projectToScreen(occlusion, clip);
+        screenMin = glm::min(screenMin, glm::vec2(screen.x, screen.y));
+        screenMax = glm::max(screenMax, glm::vec2(screen.x, screen.y));
+        nearestDepth = std::min(nearestDepth, screen.z);
+    }
+
+    // Frustum rejection comes for free from the projected bounds
+    if (screenMax.x < 0.0f || screenMax.y < 0.0f || screenMin.x > occlusion.size.x || screenMin.y > occlusion.size.y || nearestDepth > 1.0f) {
+        occlusion.culledCount++;
+
+        return true;
+    }
+
+    if (!occlusion.isEnabled || occlusion.triangles.empty()) {
+        return false;
+    }
+
+    screenMin = glm::max(screenMin, glm::vec2(0.0f, 0.0f));
+    screenMax = glm::min(screenMax, glm::vec2(occlusion.size.x - 1, occlusion.size.y - 1));
+
+    // Pick the level where the bounds cover at most 2x2 texels
+    float extent = std::max(screenMax.x - screenMin.x, screenMax.y - screenMin.y);
+    int level = std::clamp((int) std::ceil(std::log2(std::max(extent, 1.0f))), 0, (int) occlusion.levels.size() - 1);
+    const glm::ivec2 &levelSize = occlusion.levelSizes[level];
+    const std::vector<float> &depths = occlusion.levels[level];
+    int minX = std::min((int) screenMin.x >> level, levelSize.x - 1);
+    int minY = std::min((int) screenMin.y >> level, levelSize.y - 1);
+    int maxX = std::min((int) screenMax.x >> level, levelSize.x - 1);
+    int maxY = std::min((int) screenMax.y >> level, levelSize.y - 1);
+
+    for (int y = minY; y <= maxY; ++y) {
+        for (int x = minX; x <= maxX; ++x) {
+            if (depths[y * levelSize.x + x] >= nearestDepth) {
+                return false;
+            }
+        }
+    }
+
+    occlusion.culledCount++;
+
+    return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "jobs.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+struct OccluderMesh {
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+};
+
+struct ScreenTriangle {
+    glm::vec3 a;
+    glm::vec3 b;
+    glm::vec3 c;
+};
+
+struct Occlusion {
+    bool isEnabled = true;
+    glm::ivec2 size = glm::ivec2(256, 128);
+    int bandHeight = 8;
+    std::vector<ScreenTriangle> triangles;
+    std::vector<std::vector<float>> levels;
+    std::vector<glm::ivec2> levelSizes;
+    int testedCount = 0;
+    int culledCount = 0;
+};
+
+void clearOcclusion(Occlusion &occlusion);
+
+void addOccluder(Occlusion &occlusion, const glm::mat4 &modelViewProjection, const OccluderMesh &mesh);
+
+void rasterizeOcclusion(Occlusion &occlusion, Jobs &jobs);
+
+bool isOccluded(Occlusion &occlusion, const glm::mat4 &modelViewProjection, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax);
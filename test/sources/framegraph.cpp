@@ -0,0 +1,273 @@
+#include "framegraph.hpp"
+
+bool isDepthFormat(GLenum format) {
+    return format == GL_DEPTH_COMPONENT16 || format == GL_DEPTH_COMPONENT24 || format == GL_DEPTH_COMPONENT32F;
+}
+
+GLsizeiptr getAttachmentSize(const glm::ivec2 &size, GLenum format) {
+    // RGBA8 and 24 bit depth (padded) are both four bytes a texel
+    return (GLsizeiptr) size.x * size.y * (format == GL_RGBA16F ? 8 : 4);
+}
+
+void beginFrameGraph(FrameGraph &graph) {
+    graph.attachments.clear();
+    graph.passes.clear();
+    graph.frame++;
+}
+
+int importGraphAttachment(FrameGraph &graph, const std::string &name, GLuint framebuffer) {
+    GraphAttachment attachment;
+    attachment.name = name;
+    attachment.isImported = true;
+    attachment.framebuffer = framebuffer;
+    graph.attachments.push_back(attachment);
+
+    return (int) graph.attachments.size() - 1;
+}
+
+int createGraphAttachment(FrameGraph &graph, const std::string &name, const glm::ivec2 &size, GLenum format) {
+    GraphAttachment attachment;
+    attachment.name = name;
+    attachment.size = size;
+    attachment.format = format;
+    graph.attachments.push_back(attachment);
+
+    return (int) graph.attachments.size() - 1;
+}
+
+void addGraphPass(FrameGraph &graph, const std::string &name, const std::vector<int> &reads, const std::vector<int> &writes, std::function<void()> execute) {
+    GraphPass pass;
+    pass.name = name;
+    pass.reads = reads;
+    pass.writes = writes;
+    pass.execute = std::move(execute);
+    graph.passes.push_back(std::move(pass));
+}
+
+int acquireTexture(FrameGraph &graph, Resources &resources, GlState &state, const GraphAttachment &attachment) {
+    for (int a = 0; a < (int) graph.textures.size(); ++a) {
+        TransientTexture &texture = graph.textures[a];
+
+        if (!texture.isInUse && texture.size == attachment.size && texture.format == attachment.format) {
+            texture.isInUse = true;
+            texture.lastUsedFrame = graph.frame;
+
+            return a;
+        }
+    }
+
+    TransientTexture texture;
+    texture.texture = createResource(resources, ResourceType::Texture);
+    texture.size = attachment.size;
+    texture.format = attachment.format;
+    texture.isInUse = true;
+    texture.lastUsedFrame = graph.frame;
+
+    bool isDepth = isDepthFormat(attachment.format);
+    bindTextureForEdit(state, 0, GL_TEXTURE_2D, getResource(resources, texture.texture));
+    glTexImage2D(GL_TEXTURE_2D, 0, attachment.format, attachment.size.x, attachment.size.y, 0, isDepth ? GL_DEPTH_COMPONENT : GL_RGBA, isDepth ? GL_UNSIGNED_INT : GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, isDepth ? GL_NEAREST : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, isDepth ? GL_NEAREST : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    setResourceSize(resources, texture.texture, getAttachmentSize(attachment.size, attachment.format));
+    graph.textures.push_back(texture);
+
+    return (int) graph.textures.size() - 1;
+}
+
+GLuint getGraphFramebuffer(FrameGraph &graph, Resources &resources, GlState &state, const std::vector<int> &attachments) {
+    std::vector<GLuint> textures;
+    std::vector<int> unique;
+
+    for (auto index : attachments) {
+        const GraphAttachment &attachment = graph.attachments[index];
+
+        // Imported attachments come with their own framebuffer and never mix with transient ones
+        if (attachment.isImported) {
+            return attachment.framebuffer;
+        }
+
+        GLuint texture = attachment.texture == -1 ? 0 : getResource(resources, graph.textures[attachment.texture].texture);
+
+        if (std::find(textures.begin(), textures.end(), texture) == textures.end()) {
+            textures.push_back(texture);
+            unique.push_back(index);
+        }
+    }
+
+    for (auto &framebuffer : graph.framebuffers) {
+        if (framebuffer.textures == textures) {
+            return getResource(resources, framebuffer.framebuffer);
+        }
+    }
+
+    TransientFramebuffer framebuffer;
+    framebuffer.framebuffer = createResource(resources, ResourceType::Framebuffer);
+    framebuffer.textures = textures;
+    GLuint name = getResource(resources, framebuffer.framebuffer);
+    GLenum drawBuffers[8];
+    int colorCount = 0;
+    bindFramebuffer(state, GL_FRAMEBUFFER, name);
+
+    for (size_t a = 0; a < unique.size(); ++a) {
+        if (isDepthFormat(graph.attachments[unique[a]].format)) {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, textures[a], 0);
+        } else if (colorCount < 8) {
+            drawBuffers[colorCount] = GL_COLOR_ATTACHMENT0 + colorCount;
+            glFramebufferTexture2D(GL_FRAMEBUFFER, drawBuffers[colorCount], GL_TEXTURE_2D, textures[a], 0);
+            colorCount++;
+        }
+    }
+
+    // Depth-only framebuffers are incomplete on 3.3 unless draw and read buffers are off
+    if (colorCount == 0) {
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    } else {
+        glDrawBuffers(colorCount, drawBuffers);
+    }
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "Frame graph framebuffer incomplete: " << status << std::endl;
+    }
+
+    graph.framebuffers.push_back(framebuffer);
+
+    return name;
+}
+
+void cullPasses(FrameGraph &graph) {
+    // Walking back from the imported outputs, a pass survives when something after it needs one of its writes
+    std::vector<bool> isNeeded(graph.attachments.size());
+    graph.culledCount = 0;
+
+    for (size_t a = 0; a < graph.attachments.size(); ++a) {
+        isNeeded[a] = graph.attachments[a].isImported;
+    }
+
+    for (int a = (int) graph.passes.size() - 1; a >= 0; --a) {
+        GraphPass &pass = graph.passes[a];
+        pass.isCulled = std::none_of(pass.writes.begin(), pass.writes.end(), [&isNeeded](int attachment) {
+            return isNeeded[attachment];
+        });
+
+        if (pass.isCulled) {
+            graph.culledCount++;
+
+            continue;
+        }
+
+        for (auto attachment : pass.reads) {
+            isNeeded[attachment] = true;
+        }
+    }
+}
+
+void computeLifetimes(FrameGraph &graph) {
+    graph.requestedSize = 0;
+
+    for (int a = 0; a < (int) graph.passes.size(); ++a) {
+        const GraphPass &pass = graph.passes[a];
+
+        if (pass.isCulled) {
+            continue;
+        }
+
+        for (const std::vector<int>* attachments : { &pass.reads, &pass.writes }) {
+            for (auto index : *attachments) {
+                GraphAttachment &attachment = graph.attachments[index];
+                attachment.firstPass = attachment.firstPass == -1 ? a : std::min(attachment.firstPass, a);
+                attachment.lastPass = std::max(attachment.lastPass, a);
+            }
+        }
+    }
+
+    for (auto &attachment : graph.attachments) {
+        if (!attachment.isImported && attachment.firstPass != -1) {
+            graph.requestedSize += getAttachmentSize(attachment.size, attachment.format);
+        }
+    }
+}
+
+void trimTextures(FrameGraph &graph, Resources &resources) {
+    graph.allocatedSize = 0;
+
+    // Textures nobody asked for in a while go, along with every framebuffer they were attached to
+    for (size_t a = 0; a < graph.textures.size();) {
+        TransientTexture &texture = graph.textures[a];
+
+        if (texture.lastUsedFrame + GRAPH_IDLE_FRAMES >= graph.frame) {
+            graph.allocatedSize += getAttachmentSize(texture.size, texture.format);
+            a++;
+
+            continue;
+        }
+
+        GLuint name = getResource(resources, texture.texture);
+
+        for (size_t b = 0; b < graph.framebuffers.size();) {
+            TransientFramebuffer &framebuffer = graph.framebuffers[b];
+
+            if (std::find(framebuffer.textures.begin(), framebuffer.textures.end(), name) != framebuffer.textures.end()) {
+                releaseResource(resources, framebuffer.framebuffer);
+                graph.framebuffers.erase(graph.framebuffers.begin() + b);
+            } else {
+                b++;
+            }
+        }
+
+        releaseResource(resources, texture.texture);
+        graph.textures.erase(graph.textures.begin() + a);
+    }
+}
+
+void executeFrameGraph(FrameGraph &graph, Resources &resources, GlState &state, Profiler &profiler) {
+    cullPasses(graph);
+    computeLifetimes(graph);
+
+    for (int a = 0; a < (int) graph.passes.size(); ++a) {
+        GraphPass &pass = graph.passes[a];
+
+        if (pass.isCulled) {
+            continue;
+        }
+
+        for (auto &attachment : graph.attachments) {
+            if (!attachment.isImported && attachment.firstPass == a) {
+                attachment.texture = acquireTexture(graph, resources, state, attachment);
+            }
+        }
+
+        if (!pass.writes.empty()) {
+            bindFramebuffer(state, GL_FRAMEBUFFER, getGraphFramebuffer(graph, resources, state, pass.writes));
+        }
+
+        int scope = beginGpuScope(profiler, pass.name);
+        pass.execute();
+        endGpuScope(profiler, scope);
+
+        // Returned right after their last use, so a later attachment of the same shape can alias the texture
+        for (auto &attachment : graph.attachments) {
+            if (!attachment.isImported && attachment.lastPass == a) {
+                graph.textures[attachment.texture].isInUse = false;
+            }
+        }
+    }
+
+    trimTextures(graph, resources);
+}
+
+void destroyFrameGraph(FrameGraph &graph, Resources &resources) {
+    for (auto &framebuffer : graph.framebuffers) {
+        releaseResource(resources, framebuffer.framebuffer);
+    }
+
+    for (auto &texture : graph.textures) {
+        releaseResource(resources, texture.texture);
+    }
+
+    graph = FrameGraph();
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "resources.hpp"
+#include "state.hpp"
+#include "profiler.hpp"
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/vec2.hpp>
+
+const int GRAPH_IDLE_FRAMES = 3;
+
+// Transient attachments only get a texture between the first and last live pass touching them
+struct GraphAttachment {
+    std::string name;
+    glm::ivec2 size = glm::ivec2(0, 0);
+    GLenum format = GL_RGBA8;
+    bool isImported = false;
+    GLuint framebuffer = 0;
+    int texture = -1;
+    int firstPass = -1;
+    int lastPass = -1;
+};
+
+struct GraphPass {
+    std::string name;
+    std::vector<int> reads;
+    std::vector<int> writes;
+    std::function<void()> execute;
+    bool isCulled = false;
+};
+
+struct TransientTexture {
+    ResourceHandle texture;
+    glm::ivec2 size;
+    GLenum format;
+    bool isInUse = false;
+    uint64_t lastUsedFrame = 0;
+};
+
+// Keyed by the texture names attached, so any pass writing the same aliased textures shares it
+struct TransientFramebuffer {
+    ResourceHandle framebuffer;
+    std::vector<GLuint> textures;
+};
+
+struct FrameGraph {
+    std::vector<GraphAttachment> attachments;
+    std::vector<GraphPass> passes;
+    std::vector<TransientTexture> textures;
+    std::vector<TransientFramebuffer> framebuffers;
+    uint64_t frame = 0;
+    GLsizeiptr requestedSize = 0;
+    GLsizeiptr allocatedSize = 0;
+    int culledCount = 0;
+};
+
+void beginFrameGraph(FrameGraph &graph);
+
+int importGraphAttachment(FrameGraph &graph, const std::string &name, GLuint framebuffer);
+
+int createGraphAttachment(FrameGraph &graph, const std::string &name, const glm::ivec2 &size, GLenum format);
+
+void addGraphPass(FrameGraph &graph, const std::string &name, const std::vector<int> &reads, const std::vector<int> &writes, std::function<void()> execute);
+
+GLuint getGraphFramebuffer(FrameGraph &graph, Resources &resources, GlState &state, const std::vector<int> &attachments);
+
+void executeFrameGraph(FrameGraph &graph, Resources &resources, GlState &state, Profiler &profiler);
+
+void destroyFrameGraph(FrameGraph &graph, Resources &resources);
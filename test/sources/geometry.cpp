@@ -0,0 +1,218 @@
+#include "renderer.hpp"
+#include <cstddef>
+#include <glm/geometric.hpp>
+#include <glm/gtc/constants.hpp>
+
+size_t GeometryVertexHash::operator()(const GeometryVertex &vertex) const {
+    const unsigned char* bytes = (const unsigned char*) &vertex;
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (size_t a = 0; a < sizeof(GeometryVertex); ++a) {
+        hash ^= bytes[a];
+        hash *= 0x100000001b3ull;
+    }
+
+    return (size_t) hash;
+}
+
+template <typename T>
+void reserveAtLeast(T &container, size_t count) {
+    // Growing geometrically keeps many small emitter calls from reallocating every time
+    if (container.size() + count > container.capacity()) {
+        container.reserve(std::max(container.size() + count, container.capacity() * 2));
+    }
+}
+
+void reserveGeometry(GeometryBuilder &builder, size_t vertexCount, size_t indexCount) {
+    reserveAtLeast(builder.vertices, vertexCount);
+    reserveAtLeast(builder.indices, indexCount);
+
+    auto &welded = builder.weldedVertices;
+
+    if (builder.isWelding && welded.size() + vertexCount > welded.bucket_count() * welded.max_load_factor()) {
+        welded.reserve(std::max(welded.size() + vertexCount, welded.size() * 2));
+    }
+}
+
+uint32_t addVertex(GeometryBuilder &builder, const GeometryVertex &vertex) {
+    uint32_t index = (uint32_t) builder.vertices.size();
+
+    // Welding only merges bit-identical vertices, so seams with differing normals or uvs stay split
+    if (builder.isWelding) {
+        auto [found, isInserted] = builder.weldedVertices.emplace(vertex, index);
+
+        if (!isInserted) {
+            return found->second;
+        }
+    }
+
+    builder.vertices.push_back(vertex);
+
+    return index;
+}
+
+void addTriangle(GeometryBuilder &builder, uint32_t a, uint32_t b, uint32_t c) {
+    builder.indices.push_back(a);
+    builder.indices.push_back(b);
+    builder.indices.push_back(c);
+}
+
+void addQuad(GeometryBuilder &builder, const glm::vec3 &origin, const glm::vec3 &edgeA, const glm::vec3 &edgeB) {
+    glm::vec3 normal = glm::normalize(glm::cross(edgeA, edgeB));
+    reserveGeometry(builder, 4, 6);
+
+    uint32_t a = addVertex(builder, { origin, normal, glm::vec2(0.0f, 0.0f) });
+    uint32_t b = addVertex(builder, { origin + edgeA, normal, glm::vec2(1.0f, 0.0f) });
+    uint32_t c = addVertex(builder, { origin + edgeA + edgeB, normal, glm::vec2(1.0f, 1.0f) });
+    uint32_t d = addVertex(builder, { origin + edgeB, normal, glm::vec2(0.0f, 1.0f) });
+    addTriangle(builder, a, b, c);
+    addTriangle(builder, a, c, d);
+}
+
+void addBox(GeometryBuilder &builder, const glm::vec3 &center, const glm::vec3 &halfExtents) {
+    reserveGeometry(builder, 24, 36);
+
+    for (int axis = 0; axis < 3; ++axis) {
+        glm::vec3 normal = glm::vec3(0.0f);
+        glm::vec3 edgeA = glm::vec3(0.0f);
+        glm::vec3 edgeB = glm::vec3(0.0f);
+        normal[axis] = halfExtents[axis];
+        edgeA[(axis + 1) % 3] = halfExtents[(axis + 1) % 3] * 2.0f;
+        edgeB[(axis + 2) % 3] = halfExtents[(axis + 2) % 3] * 2.0f;
+
+        // Swapping the edges flips the winding for the negative face
+        addQuad(builder, center + normal - (edgeA + edgeB) * 0.5f, edgeA, edgeB);
+        addQuad(builder, center - normal - (edgeA + edgeB) * 0.5f, edgeB, edgeA);
+    }
+}
+
+void addSphere(GeometryBuilder &builder, const glm::vec3 &center, float radius, int slices, int stacks) {
+    reserveGeometry(builder, (slices + 1) * (stacks + 1), slices * stacks * 6);
+    std::vector<uint32_t> ring((slices + 1) * (stacks + 1));
+
+    for (int stack = 0; stack <= stacks; ++stack) {
+        float phi = glm::pi<float>() * stack / stacks;
+
+        for (int slice = 0; slice <= slices; ++slice) {
+            float theta = glm::two_pi<float>() * slice / slices;
+            glm::vec3 normal = glm::vec3(sinf(phi) * cosf(theta), cosf(phi), sinf(phi) * sinf(theta));
+            ring[stack * (slices + 1) + slice] = addVertex(builder, { center + normal * radius, normal, glm::vec2((float) slice / slices, (float) stack / stacks) });
+        }
+    }
+
+    for (int stack = 0; stack < stacks; ++stack) {
+        for (int slice = 0; slice < slices; ++slice) {
+            uint32_t a = ring[stack * (slices + 1) + slice];
+            uint32_t b = ring[(stack + 1) * (slices + 1) + slice];
+            uint32_t c = ring[(stack + 1) * (slices + 1) + slice + 1];
+            uint32_t d = ring[stack * (slices + 1) + slice + 1];
+            addTriangle(builder, a, c, b);
+            addTriangle(builder, a, d, c);
+        }
+    }
+}
+
+void addDisc(GeometryBuilder &builder, const glm::vec3 &center, float radius, int slices, bool isUp) {
+    glm::vec3 normal = glm::vec3(0.0f, isUp ? 1.0f : -1.0f, 0.0f);
+    uint32_t middle = addVertex(builder, { center, normal, glm::vec2(0.5f, 0.5f) });
+    uint32_t previous = 0;
+
+    for (int slice = 0; slice <= slices; ++slice) {
+        float theta = glm::two_pi<float>() * slice / slices;
+        glm::vec2 direction = glm::vec2(cosf(theta), sinf(theta));
+        uint32_t current = addVertex(builder, { center + glm::vec3(direction.x, 0.0f, direction.y) * radius, normal, direction * 0.5f + 0.5f });
+
+        if (slice > 0) {
+            isUp ? addTriangle(builder, middle, current, previous) : addTriangle(builder, middle, previous, current);
+        }
+
+        previous = current;
+    }
+}
+
+void addCylinder(GeometryBuilder &builder, const glm::vec3 &center, float radius, float height, int slices) {
+    reserveGeometry(builder, (slices + 1) * 4 + 2, slices * 12);
+    glm::vec3 bottom = center - glm::vec3(0.0f, height * 0.5f, 0.0f);
+    glm::vec3 top = center + glm::vec3(0.0f, height * 0.5f, 0.0f);
+    uint32_t previousBottom = 0;
+    uint32_t previousTop = 0;
+
+    for (int slice = 0; slice <= slices; ++slice) {
+        float theta = glm::two_pi<float>() * slice / slices;
+        glm::vec3 normal = glm::vec3(cosf(theta), 0.0f, sinf(theta));
+        float u = (float) slice / slices;
+        uint32_t currentBottom = addVertex(builder, { bottom + normal * radius, normal, glm::vec2(u, 0.0f) });
+        uint32_t currentTop = addVertex(builder, { top + normal * radius, normal, glm::vec2(u, 1.0f) });
+
+        if (slice > 0) {
+            addTriangle(builder, previousBottom, previousTop, currentTop);
+            addTriangle(builder, previousBottom, currentTop, currentBottom);
+        }
+
+        previousBottom = currentBottom;
+        previousTop = currentTop;
+    }
+
+    addDisc(builder, bottom, radius, slices, false);
+    addDisc(builder, top, radius, slices, true);
+}
+
+void addCone(GeometryBuilder &builder, const glm::vec3 &center, float radius, float height, int slices) {
+    reserveGeometry(builder, (slices + 1) * 3 + 1, slices * 6);
+    glm::vec3 base = center - glm::vec3(0.0f, height * 0.5f, 0.0f);
+    glm::vec3 apex = center + glm::vec3(0.0f, height * 0.5f, 0.0f);
+    uint32_t previous = 0;
+
+    for (int slice = 0; slice <= slices; ++slice) {
+        float theta = glm::two_pi<float>() * slice / slices;
+        glm::vec3 direction = glm::vec3(cosf(theta), 0.0f, sinf(theta));
+        glm::vec3 normal = glm::normalize(direction * height + glm::vec3(0.0f, radius, 0.0f));
+        uint32_t current = addVertex(builder, { base + direction * radius, normal, glm::vec2((float) slice / slices, 0.0f) });
+
+        // The apex gets one vertex per slice so its normal follows the side it belongs to
+        if (slice > 0) {
+            float middle = glm::two_pi<float>() * (slice - 0.5f) / slices;
+            glm::vec3 apexNormal = glm::normalize(glm::vec3(cosf(middle) * height, radius, sinf(middle) * height));
+            uint32_t top = addVertex(builder, { apex, apexNormal, glm::vec2((slice - 0.5f) / slices, 1.0f) });
+            addTriangle(builder, previous, top, current);
+        }
+
+        previous = current;
+    }
+
+    addDisc(builder, base, radius, slices, false);
+}
+
+int buildModel(Model &model, const GeometryBuilder &builder, const std::string &name) {
+    if (builder.vertices.empty() || builder.indices.empty()) {
+        std::cout << "Geometry is empty" << std::endl;
+
+        return -1;
+    }
+
+    // One interleaved view plus an index view, laid out the way a loaded GLB would be
+    int vertexLength = (int) (builder.vertices.size() * sizeof(GeometryVertex));
+    int indexLength = (int) (builder.indices.size() * sizeof(uint32_t));
+    int vertexCount = (int) builder.vertices.size();
+    model.buffer.resize(vertexLength + indexLength);
+    memcpy(model.buffer.data(), builder.vertices.data(), vertexLength);
+    memcpy(model.buffer.data() + vertexLength, builder.indices.data(), indexLength);
+
+    model.bufferViews = {
+        { 0, vertexLength, 0, (int) sizeof(GeometryVertex) },
+        { 0, indexLength, vertexLength }
+    };
+    model.accessors = {
+        { 0, GL_FLOAT, vertexCount, "VEC3", (int) offsetof(GeometryVertex, position) },
+        { 0, GL_FLOAT, vertexCount, "VEC3", (int) offsetof(GeometryVertex, normal) },
+        { 0, GL_FLOAT, vertexCount, "VEC2", (int) offsetof(GeometryVertex, uv) },
+        { 1, GL_UNSIGNED_INT, (int) builder.indices.size(), "SCALAR" }
+    };
+    model.meshes = { { name, { { { { "POSITION", 0 }, { "NORMAL", 1 }, { "TEXCOORD_0", 2 } }, 3 } } } };
+    model.nodes = { { name, 0 } };
+    model.scenes = { { name, { 0 } } };
+    model.scene = 0;
+    computeBounds(model);
+
+    return 0;
+}
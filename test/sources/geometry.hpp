@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+struct Model;
+
+struct GeometryVertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 uv;
+
+    bool operator==(const GeometryVertex &other) const {
+        return memcmp(this, &other, sizeof(GeometryVertex)) == 0;
+    }
+};
+
+struct GeometryVertexHash {
+    size_t operator()(const GeometryVertex &vertex) const;
+};
+
+// Interleaved position/normal/uv storage that emitters append to directly
+struct GeometryBuilder {
+    std::vector<GeometryVertex> vertices;
+    std::vector<uint32_t> indices;
+    bool isWelding = false;
+    std::unordered_map<GeometryVertex, uint32_t, GeometryVertexHash> weldedVertices;
+};
+
+void reserveGeometry(GeometryBuilder &builder, size_t vertexCount, size_t indexCount);
+
+uint32_t addVertex(GeometryBuilder &builder, const GeometryVertex &vertex);
+
+void addQuad(GeometryBuilder &builder, const glm::vec3 &origin, const glm::vec3 &edgeA, const glm::vec3 &edgeB);
+
+void addBox(GeometryBuilder &builder, const glm::vec3 &center, const glm::vec3 &halfExtents);
+
+void addSphere(GeometryBuilder &builder, const glm::vec3 &center, float radius, int slices, int stacks);
+
+void addCylinder(GeometryBuilder &builder, const glm::vec3 &center, float radius, float height, int slices);
+
+void addCone(GeometryBuilder &builder, const glm::vec3 &center, float radius, float height, int slices);
+
+int buildModel(Model &model, const GeometryBuilder &builder, const std::string &name);
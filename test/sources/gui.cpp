@@ -8,7 +8,93 @@ int TextFilters::ProjectName(ImGuiInputTextCallbackData* data) {
     return 1;
 }
 
+void renderProfiler(const RenderStats &stats) {
+    ImGui::Begin("Profiler");
+
+    if (ImPlot::BeginPlot("GPU Time", ImVec2(-1, 200))) {
+        ImPlot::SetupAxes("Frame", "ms", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+
+        for (auto &timing : stats.timings) {
+            ImPlot::PlotLine(timing.name.c_str(), timing.history.data(), (int) timing.history.size());
+        }
+
+        ImPlot::EndPlot();
+    }
+
+    for (auto &timing : stats.timings) {
+        ImGui::Text("%*s%s: %.3f ms", timing.depth * 2, "", timing.name.c_str(), timing.milliseconds);
+    }
+
+    ImGui::Separator();
+    ImGui::Text("Passes: %d, %d culled", stats.graphPassCount, stats.culledPassCount);
+    ImGui::Text("Transient: %.1f MB allocated for %.1f MB of attachments", stats.transientSize / (1024.0f * 1024.0f), stats.transientRequestedSize / (1024.0f * 1024.0f));
+
+    ImGui::End();
+}
+
+void renderPacing(FramePacing &pacing) {
+    ImGui::Begin("Frame Pacing");
+
+    const char* modes[] = { "Vsync", "Adaptive Vsync", "Uncapped", "Limited" };
+    int mode = (int) pacing.mode;
+
+    if (ImGui::Combo("Mode", &mode, modes, IM_ARRAYSIZE(modes))) {
+        pacing.mode = (PacingMode) mode;
+    }
+
+    if (pacing.mode == PacingMode::Limited) {
+        ImGui::DragFloat("Target Rate", &pacing.targetRate, 1.0f, 10.0f, 1000.0f);
+        ImGui::DragFloat("Spin (ms)", &pacing.spinMilliseconds, 0.1f, 0.0f, 10.0f);
+    }
+
+    PacingStats stats = getPacingStats(pacing);
+    ImGui::Text("Average: %.2f ms, Deviation: %.2f ms", stats.average, stats.deviation);
+    ImGui::Text("99th: %.2f ms, Max: %.2f ms", stats.percentile99, stats.maximum);
+
+    std::vector<float> history = getPacingHistory(pacing);
+
+    if (ImPlot::BeginPlot("Frame Times", ImVec2(-1, 150))) {
+        ImPlot::SetupAxes("Frame", "ms", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+        ImPlot::PlotLine("Frame Time", history.data(), (int) history.size());
+        ImPlot::EndPlot();
+    }
+
+    if (ImPlot::BeginPlot("Histogram", ImVec2(-1, 150))) {
+        ImPlot::SetupAxes("ms", "Frames", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+        ImPlot::PlotHistogram("Frame Time", history.data(), (int) history.size(), 50);
+        ImPlot::EndPlot();
+    }
+
+    ImGui::End();
+}
+
+void renderViewport(Renderer &renderer) {
+#ifdef IMGUI_HAS_DOCK
+    ImGui::DockSpaceOverViewport(ImGui::GetMainViewport(), ImGuiDockNodeFlags_PassthruCentralNode);
+#endif
+
+    if (!renderer.isViewportPanel) {
+        return;
+    }
+
+    ImGui::SetNextWindowSize(ImVec2(960, 540), ImGuiCond_FirstUseEver);
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
+    ImGui::Begin("Scene", nullptr, ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
+
+    // The scene is rendered at the panel's pixel size, so whatever the other panels cover is never shaded
+    ImVec2 size = ImGui::GetContentRegionAvail();
+    ImVec2 scale = ImGui::GetIO().DisplayFramebufferScale;
+    renderer.panelSize = glm::max(glm::ivec2((int) (size.x * scale.x), (int) (size.y * scale.y)), glm::ivec2(1, 1));
+
+    // Resources belong to the render thread, so the texture name comes back with the frame stats
+    ImGui::Image((ImTextureID) (intptr_t) renderer.stats.viewportTexture, size, ImVec2(0, 1), ImVec2(1, 0));
+
+    ImGui::End();
+    ImGui::PopStyleVar();
+}
+
 void renderGui(entt::registry &registry, Renderer &renderer) {
+    renderViewport(renderer);
     ImGui::ShowDemoWindow();
 
     {
@@ -101,8 +187,87 @@ void renderGui(entt::registry &registry, Renderer &renderer) {
     ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
     ImGui::ColorEdit4("Clear Color", (float*) &renderer.clearColor);
     ImGui::ColorEdit3("Grid Color", (float*) &renderer.grid.color);
+    ImGui::DragFloat("Grid Fade Radius", &renderer.grid.fadeRadius, 1.0f, 1.0f, 1000.0f);
     ImGui::DragFloat3("Camera Position", (float*) &renderer.camera.position, 0.1f);
     ImGui::DragFloat("Camera Speed", (float*) &renderer.camera.speed, 0.1f);
+    ImGui::Checkbox("Occlusion Culling", &renderer.occlusion.isEnabled);
+    ImGui::Text("Culled: %d / %d", renderer.occlusion.culledCount, renderer.occlusion.testedCount);
+    ImGui::Checkbox("Depth Prepass", &renderer.isDepthPrepass);
+    ImGui::Checkbox("Scene Viewport", &renderer.isViewportPanel);
+
+    if (renderer.pulling.isSupported) {
+        ImGui::Checkbox("Vertex Pulling", &renderer.isVertexPulling);
+        ImGui::Text("Multi-draws: %d", renderer.stats.multiDrawCount);
+    }
+
+    ImGui::Checkbox("Impostors", &renderer.impostors.isEnabled);
+
+    if (renderer.impostors.isEnabled) {
+        ImGui::DragFloat("Impostor Distance", &renderer.impostors.distance, 1.0f, 1.0f, 10000.0f);
+    }
+
+    ImGui::Text("Impostors: %d", renderer.stats.impostorCount);
+
+    // Vertex pulling is a separate draw path rather than a look, it has its own toggle
+    for (int a = 0; a < SHADER_FEATURE_COUNT; ++a) {
+        if ((1u << a) == SHADER_FEATURE_VERTEX_PULLING) {
+            continue;
+        }
+
+        ImGui::CheckboxFlags(SHADER_FEATURE_NAMES[a], &renderer.shaderFeatures, 1u << a);
+    }
+
+    ImGui::Text("Compiling Shaders: %d", renderer.stats.pendingShaderCount);
+    int lightCount = (int) renderer.lighting.lights.size();
+
+    if (ImGui::DragInt("Lights", &lightCount, 1.0f, 0, 65536)) {
+        scatterLights(renderer.lighting, lightCount, 20.0f);
+    }
+
+    ImGui::Checkbox("Dynamic Resolution", &renderer.resolution.isEnabled);
+
+    if (renderer.resolution.isEnabled) {
+        ImGui::DragFloat("Target Time (ms)", &renderer.resolution.targetMilliseconds, 0.1f, 1.0f, 100.0f);
+        ImGui::SliderFloat("Min Scale", &renderer.resolution.minScale, 0.1f, 1.0f);
+        ImGui::SliderFloat("Max Scale", &renderer.resolution.maxScale, 0.1f, 1.0f);
+    }
+
+    ImGui::Text("Resolution: %d x %d", renderer.stats.renderSize.x, renderer.stats.renderSize.y);
+    float textureBudget = renderer.streaming.budget / (1024.0f * 1024.0f);
+
+    if (ImGui::DragFloat("Texture Budget (MB)", &textureBudget, 1.0f, 16.0f, 4096.0f)) {
+        renderer.streaming.budget = (GLsizeiptr) (textureBudget * 1024.0f * 1024.0f);
+    }
+
+    ImGui::Text("Textures: %.1f / %.1f MB", renderer.stats.textureSize / (1024.0f * 1024.0f), renderer.stats.textureBudget / (1024.0f * 1024.0f));
+    ImGui::Text("Shader Cache: %d hits, %d misses", renderer.stats.shaderCacheHitCount, renderer.stats.shaderCacheMissCount);
+    ImGui::Text("GL Calls: %d issued, %d elided", renderer.stats.issuedCount, renderer.stats.elidedCount);
+    ImGui::Text("Uniforms: %.1f / %.1f KB", renderer.stats.uniformSize / 1024.0f, renderer.stats.uniformFrameSize / 1024.0f);
+    ImGui::Text("Transforms: %.1f KB uploaded, %d slots", renderer.stats.transformSize / 1024.0f, renderer.transformSlots.count);
+    float uploadBudget = renderer.uploads.budget / (1024.0f * 1024.0f);
+
+    if (ImGui::DragFloat("Upload Budget (MB)", &uploadBudget, 0.1f, 0.25f, 256.0f)) {
+        renderer.uploads.budget = (GLsizeiptr) (uploadBudget * 1024.0f * 1024.0f);
+    }
+
+    ImGui::Text("Uploads: %.1f KB this frame, %.1f MB pending", renderer.stats.uploadSize / 1024.0f, renderer.stats.pendingUploadSize / (1024.0f * 1024.0f));
+
+    if (ImGui::CollapsingHeader("GPU Memory")) {
+        float memoryBudget = renderer.memoryBudget / (1024.0f * 1024.0f);
+        float totalSize = 0.0f;
+
+        if (ImGui::DragFloat("Memory Budget (MB)", &memoryBudget, 1.0f, 64.0f, 16384.0f)) {
+            renderer.memoryBudget = (GLsizeiptr) (memoryBudget * 1024.0f * 1024.0f);
+        }
+
+        for (int a = 0; a < RESOURCE_TYPE_COUNT; ++a) {
+            totalSize += renderer.stats.resourceSizes[a] / (1024.0f * 1024.0f);
+            ImGui::Text("%s: %d, %.1f MB", RESOURCE_TYPE_NAMES[a], renderer.stats.resourceCounts[a], renderer.stats.resourceSizes[a] / (1024.0f * 1024.0f));
+        }
+
+        ImGui::Text("Total: %.1f / %.1f MB", totalSize, memoryBudget);
+        ImGui::Text("Retiring: %.1f MB", renderer.stats.retiringSize / (1024.0f * 1024.0f));
+    }
 
     static auto view = registry.view<Node>();
     static entt::entity selected = entt::null;
@@ -129,9 +294,15 @@ void renderGui(entt::registry &registry, Renderer &renderer) {
             if (registry.any_of<Transform>(selected) && ImGui::TreeNode("Transform")) {
                 auto &transform = registry.get<Transform>(selected);
 
-                ImGui::DragFloat3("Translation", (float*) &transform.translation, 0.1f);
-                ImGui::DragFloat3("Rotation", (float*) &transform.rotation, 0.1f);
-                ImGui::DragFloat3("Scale", (float*) &transform.scale, 0.1f);
+                bool isChanged = ImGui::DragFloat3("Translation", (float*) &transform.translation, 0.1f);
+                isChanged |= ImGui::DragFloat3("Rotation", (float*) &transform.rotation, 0.1f);
+                isChanged |= ImGui::DragFloat3("Scale", (float*) &transform.scale, 0.1f);
+
+                // Patching is what tells the transform observer this entity needs a new matrix uploaded
+                if (isChanged) {
+                    registry.patch<Transform>(selected);
+                }
+
                 ImGui::TreePop();
             }
         } else {
@@ -172,4 +343,6 @@ void renderGui(entt::registry &registry, Renderer &renderer) {
     }
 
     ImGui::End();
+
+    renderProfiler(renderer.stats);
 }
@@ -1,8 +1,10 @@
 #pragma once
 #include <imgui/imgui.h>
+#include <implot/implot.h>
 #include <entt/entt.hpp>
 #include "renderer.hpp"
 #include "utility.hpp"
+#include "pacing.hpp"
 #include <filesystem>
 
 namespace fs = std::filesystem;
@@ -11,4 +13,10 @@ struct TextFilters {
     static int ProjectName(ImGuiInputTextCallbackData* data);
 };
 
+void renderProfiler(const RenderStats &stats);
+
+void renderPacing(FramePacing &pacing);
+
+void renderViewport(Renderer &renderer);
+
 void renderGui(entt::registry &registry, Renderer &renderer);
@@ -0,0 +1,164 @@
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+#include "headless.hpp"
+
+int parseHeadlessOptions(HeadlessOptions &options, int argc, char* argv[]) {
+    for (int a = 1; a < argc; ++a) {
+        std::string argument = argv[a];
+        bool hasValue = a + 1 < argc;
+
+        if (argument == "--frames" && hasValue) {
+            if (sscanf(argv[++a], "%d", &options.frameCount) != 1 || options.frameCount <= 0) {
+                std::cout << "Invalid frame count, expected a positive number" << std::endl;
+
+                return -1;
+            }
+        } else if (argument == "--size" && hasValue) {
+            if (sscanf(argv[++a], "%dx%d", &options.size.x, &options.size.y) != 2 || options.size.x <= 0 || options.size.y <= 0) {
+                std::cout << "Invalid size, expected <width>x<height>" << std::endl;
+
+                return -1;
+            }
+        } else if (argument == "--png" && hasValue) {
+            options.imagePrefix = argv[++a];
+        } else if (argument == "--png-interval" && hasValue) {
+            if (sscanf(argv[++a], "%d", &options.imageInterval) != 1 || options.imageInterval < 0) {
+                std::cout << "Invalid PNG interval, expected zero or a positive number" << std::endl;
+
+                return -1;
+            }
+        } else if (argument == "--timings" && hasValue) {
+            options.timingsPath = argv[++a];
+        }
+    }
+
+    return 0;
+}
+
+int createHeadlessContext(HeadlessContext &headless) {
+    // Surfaceless needs no display server, llvmpipe makes it work without a GPU too
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+    if (getPlatformDisplay) {
+        headless.display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+
+    if (headless.display == EGL_NO_DISPLAY) {
+        headless.display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    if (headless.display == EGL_NO_DISPLAY || !eglInitialize(headless.display, nullptr, nullptr)) {
+        std::cout << "Failed to initialize EGL display" << std::endl;
+
+        return -1;
+    }
+
+    EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+
+    EGLConfig config;
+    EGLint configCount = 0;
+
+    if (!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(headless.display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+        std::cout << "Failed to choose EGL config" << std::endl;
+        eglTerminate(headless.display);
+
+        return -1;
+    }
+
+    EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+
+    headless.context = eglCreateContext(headless.display, config, EGL_NO_CONTEXT, contextAttributes);
+
+    if (headless.context == EGL_NO_CONTEXT || !eglMakeCurrent(headless.display, EGL_NO_SURFACE, EGL_NO_SURFACE, headless.context)) {
+        std::cout << "Failed to create surfaceless GL context: " << eglGetError() << std::endl;
+        eglTerminate(headless.display);
+
+        return -1;
+    }
+
+    if (!gladLoadGLLoader((GLADloadproc) eglGetProcAddress)) {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        destroyHeadlessContext(headless);
+
+        return -1;
+    }
+
+    return 0;
+}
+
+void destroyHeadlessContext(HeadlessContext &headless) {
+    eglMakeCurrent(headless.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(headless.display, headless.context);
+    eglTerminate(headless.display);
+    headless.display = EGL_NO_DISPLAY;
+    headless.context = EGL_NO_CONTEXT;
+}
+
+int writeFrameImage(const HeadlessContext &headless, const Resources &resources, const std::string &path) {
+    glm::ivec2 size = headless.target.size;
+    std::vector<unsigned char> pixels(size.x * size.y * 4);
+    GLint lastFramebuffer;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &lastFramebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, getResource(resources, headless.target.framebuffer));
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, lastFramebuffer);
+
+    // GL rows start at the bottom
+    stbi_flip_vertically_on_write(1);
+
+    if (!stbi_write_png(path.c_str(), size.x, size.y, 4, pixels.data(), size.x * 4)) {
+        std::cout << "Failed to write frame image: " << path << std::endl;
+
+        return -1;
+    }
+
+    return 0;
+}
+
+int writeHeadlessTimings(const HeadlessOptions &options, const HeadlessTimings &timings) {
+    std::ofstream file(options.timingsPath);
+
+    if (!file.is_open()) {
+        std::cout << "Failed to open timings file: " << options.timingsPath << std::endl;
+
+        return -1;
+    }
+
+    float frameTotal = 0.0f;
+
+    for (auto milliseconds : timings.frameMilliseconds) {
+        frameTotal += milliseconds;
+    }
+
+    file << "{\n";
+    file << "    \"frames\": " << timings.frameMilliseconds.size() << ",\n";
+    file << "    \"width\": " << options.size.x << ",\n";
+    file << "    \"height\": " << options.size.y << ",\n";
+    file << "    \"frameAverage\": " << (timings.frameMilliseconds.empty() ? 0.0f : frameTotal / timings.frameMilliseconds.size()) << ",\n";
+    file << "    \"samples\": [\n";
+
+    for (size_t a = 0; a < timings.frameMilliseconds.size(); ++a) {
+        file << "        { \"frame\": " << timings.frameMilliseconds[a] << ", \"gpu\": {";
+
+        for (size_t b = 0; b < timings.gpuTimings[a].size(); ++b) {
+            file << (b ? ", " : " ") << "\"" << timings.gpuTimings[a][b].name << "\": " << timings.gpuTimings[a][b].milliseconds;
+        }
+
+        file << " } }" << (a + 1 < timings.frameMilliseconds.size() ? "," : "") << "\n";
+    }
+
+    file << "    ]\n";
+    file << "}\n";
+
+    return 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "resolution.hpp"
+#include "profiler.hpp"
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <glm/vec2.hpp>
+
+struct HeadlessOptions {
+    int frameCount = 100;
+    glm::ivec2 size = glm::ivec2(1280, 720);
+    std::string imagePrefix;
+    int imageInterval = 0;
+    std::string timingsPath;
+};
+
+struct HeadlessContext {
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    RenderTarget target;
+};
+
+struct HeadlessTimings {
+    std::vector<float> frameMilliseconds;
+    std::vector<std::vector<GpuTiming>> gpuTimings;
+};
+
+int parseHeadlessOptions(HeadlessOptions &options, int argc, char* argv[]);
+
+int createHeadlessContext(HeadlessContext &headless);
+
+void destroyHeadlessContext(HeadlessContext &headless);
+
+int writeFrameImage(const HeadlessContext &headless, const Resources &resources, const std::string &path);
+
+int writeHeadlessTimings(const HeadlessOptions &options, const HeadlessTimings &timings);
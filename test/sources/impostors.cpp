@@ -0,0 +1,282 @@
+#include "renderer.hpp"
+
+glm::vec3 decodeOctahedral(const glm::vec2 &coordinate) {
+    glm::vec3 direction = glm::vec3(coordinate.x, 1.0f - std::abs(coordinate.x) - std::abs(coordinate.y), coordinate.y);
+
+    // Lower hemisphere is folded out over the diamond's edges, same as include/octahedral.glsl
+    if (direction.y < 0.0f) {
+        float x = direction.x;
+        direction.x = (1.0f - std::abs(direction.z)) * (x >= 0.0f ? 1.0f : -1.0f);
+        direction.z = (1.0f - std::abs(x)) * (direction.z >= 0.0f ? 1.0f : -1.0f);
+    }
+
+    return glm::normalize(direction);
+}
+
+void createImpostors(Impostors &impostors, Resources &resources) {
+    // Lit like the default main shader variant, so the handover only swaps geometry
+    impostors.program = adoptResource(resources, ResourceType::Program, loadShaderProgram("../assets/shaders/impostor.glsl", getFeatureDefines(SHADER_FEATURES_DEFAULT)));
+    impostors.bakeProgram = adoptResource(resources, ResourceType::Program, loadShaderProgram("../assets/shaders/impostor_bake.glsl"));
+    GLuint program = getResource(resources, impostors.program);
+
+    if (program) {
+        bindUniformBlocks(program);
+        bindLightSamplers(program);
+        bindTransformSampler(program);
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "u_ImpostorColor"), IMPOSTOR_COLOR_TEXTURE_UNIT);
+        glUniform1i(glGetUniformLocation(program, "u_ImpostorNormal"), IMPOSTOR_NORMAL_TEXTURE_UNIT);
+        glUseProgram(0);
+    }
+
+    // Quads come from gl_VertexID, the only attribute is the instance's transform slot
+    impostors.slotBuffer = createResource(resources, ResourceType::Buffer);
+    impostors.vao = createResource(resources, ResourceType::VertexArray);
+    glBindVertexArray(getResource(resources, impostors.vao));
+    glBindBuffer(GL_ARRAY_BUFFER, getResource(resources, impostors.slotBuffer));
+    glEnableVertexAttribArray(IMPOSTOR_SLOT_LOCATION);
+    glVertexAttribIPointer(IMPOSTOR_SLOT_LOCATION, 1, GL_UNSIGNED_INT, sizeof(GLuint), nullptr);
+    glVertexAttribDivisor(IMPOSTOR_SLOT_LOCATION, 1);
+    glBindVertexArray(0);
+}
+
+void destroyImpostors(Impostors &impostors, Resources &resources) {
+    for (auto &atlas : impostors.atlases) {
+        releaseResource(resources, atlas.colorTexture);
+        releaseResource(resources, atlas.normalTexture);
+    }
+
+    releaseResource(resources, impostors.program);
+    releaseResource(resources, impostors.bakeProgram);
+    releaseResource(resources, impostors.slotBuffer);
+    releaseResource(resources, impostors.vao);
+    impostors.atlases.clear();
+}
+
+ResourceHandle createAtlasTexture(Resources &resources, int size, int maxLevel) {
+    ResourceHandle texture = createResource(resources, ResourceType::Texture);
+    glBindTexture(GL_TEXTURE_2D, getResource(resources, texture));
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, maxLevel);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // The mip chain adds about a third on top of the base level
+    setResourceSize(resources, texture, (GLsizeiptr) size * size * 4 * 4 / 3);
+
+    return texture;
+}
+
+void drawImpostorView(Renderer &renderer, const Model &model, GLint layerLocation) {
+    for (auto nodeIndex : model.scenes[model.scene].nodes) {
+        const Node &node = model.nodes[nodeIndex];
+
+        if (node.mesh > -1 && !isOccluderMesh(model.meshes[node.mesh])) {
+            const MeshPrimitive &meshPrimitive = model.meshes[node.mesh].primitives[0];
+            const Accessor &indexAccessor = model.accessors[meshPrimitive.indices];
+            TextureHandle handle = getMaterialHandle(model, meshPrimitive.material);
+
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, getPageTexture(renderer, handle));
+            glUniform1f(layerLocation, (float) handle.layer);
+            glBindVertexArray(getResource(renderer.resources, model.vao));
+            glDrawElements(GL_TRIANGLES, indexAccessor.count, indexAccessor.componentType, (const void*) (uintptr_t) indexAccessor.byteOffset);
+        }
+    }
+}
+
+int bakeImpostor(Renderer &renderer, Model &model) {
+    Impostors &impostors = renderer.impostors;
+    Resources &resources = renderer.resources;
+    GLuint bakeProgram = getResource(resources, impostors.bakeProgram);
+    ImpostorAtlas atlas;
+    atlas.gridSize = impostors.gridSize;
+    atlas.center = (model.boundsMin + model.boundsMax) * 0.5f;
+    atlas.radius = glm::length(model.boundsMax - model.boundsMin) * 0.5f;
+
+    if (!bakeProgram || atlas.radius <= 0.0f) {
+        return -1;
+    }
+
+    // Baking draws the model right away, so its data can't wait for the upload budget
+    finishUploads(renderer.uploads, resources, renderer.state);
+
+    // Mips stop while a cell is still a few texels wide, past that neighbouring views would bleed together
+    int size = atlas.gridSize * impostors.frameSize;
+    int maxLevel = std::max((int) std::log2((float) impostors.frameSize) - 3, 0);
+    atlas.colorTexture = createAtlasTexture(resources, size, maxLevel);
+    atlas.normalTexture = createAtlasTexture(resources, size, maxLevel);
+
+    ResourceHandle depthRenderbuffer = createResource(resources, ResourceType::Renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, getResource(resources, depthRenderbuffer));
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, size, size);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    setResourceSize(resources, depthRenderbuffer, (GLsizeiptr) size * size * 4);
+
+    ResourceHandle framebuffer = createResource(resources, ResourceType::Framebuffer);
+    GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glBindFramebuffer(GL_FRAMEBUFFER, getResource(resources, framebuffer));
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, getResource(resources, atlas.colorTexture), 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, getResource(resources, atlas.normalTexture), 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, getResource(resources, depthRenderbuffer));
+    glDrawBuffers(2, drawBuffers);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+    if (status == GL_FRAMEBUFFER_COMPLETE) {
+        glViewport(0, 0, size, size);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthMask(GL_TRUE);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LESS);
+        glDisable(GL_BLEND);
+        glUseProgram(bakeProgram);
+
+        GLint viewProjectionLocation = glGetUniformLocation(bakeProgram, "u_ViewProjection");
+        GLint layerLocation = glGetUniformLocation(bakeProgram, "u_Layer");
+        glm::mat4 projection = glm::ortho(-atlas.radius, atlas.radius, -atlas.radius, atlas.radius, 0.0f, atlas.radius * 4.0f);
+
+        // Cell centres and view bases match what impostor.glsl picks at runtime, so every quad lines up with its view
+        for (int y = 0; y < atlas.gridSize; ++y) {
+            for (int x = 0; x < atlas.gridSize; ++x) {
+                glm::vec3 direction = decodeOctahedral((glm::vec2((float) x, (float) y) + 0.5f) / (float) atlas.gridSize * 2.0f - 1.0f);
+                glm::vec3 up = std::abs(direction.y) > 0.999f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+                glm::mat4 view = glm::lookAt(atlas.center + direction * atlas.radius * 2.0f, atlas.center, up);
+
+                glViewport(x * impostors.frameSize, y * impostors.frameSize, impostors.frameSize, impostors.frameSize);
+                glUniformMatrix4fv(viewProjectionLocation, 1, GL_FALSE, glm::value_ptr(projection * view));
+                drawImpostorView(renderer, model, layerLocation);
+            }
+        }
+    } else {
+        std::cout << "Impostor framebuffer incomplete: " << status << std::endl;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    releaseResource(resources, framebuffer);
+    releaseResource(resources, depthRenderbuffer);
+
+    // Everything above went around the state cache
+    invalidateState(renderer.state);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        releaseResource(resources, atlas.colorTexture);
+        releaseResource(resources, atlas.normalTexture);
+
+        return -1;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, getResource(resources, atlas.colorTexture));
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, getResource(resources, atlas.normalTexture));
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    model.impostor = (int) impostors.atlases.size();
+    impostors.atlases.push_back(atlas);
+
+    return model.impostor;
+}
+
+void selectImpostors(Renderer &renderer, Frame &frame) {
+    Impostors &impostors = renderer.impostors;
+    std::vector<std::pair<int, GLuint>> &selection = impostors.selection;
+    frame.impostorSlots.clear();
+    frame.impostorBatches.clear();
+    selection.clear();
+
+    if (!impostors.isEnabled || impostors.atlases.empty()) {
+        return;
+    }
+
+    // Far instances leave the draw list, so nothing downstream spends mesh work or texture requests on them
+    float distanceSquared = impostors.distance * impostors.distance;
+    size_t keptCount = 0;
+
+    for (auto instanceIndex : frame.drawList) {
+        const Instance &instance = frame.instances[instanceIndex];
+        const Model &model = renderer.models[instance.model];
+
+        if (model.impostor != -1 && instance.transform != -1) {
+            glm::vec4 center = instance.matrix * glm::vec4((model.boundsMin + model.boundsMax) * 0.5f, 1.0f);
+            glm::vec3 delta = glm::vec3(center.x, center.y, center.z) - frame.camera.position;
+
+            if (glm::dot(delta, delta) > distanceSquared) {
+                selection.push_back({ model.impostor, (GLuint) instance.transform });
+
+                continue;
+            }
+        }
+
+        frame.drawList[keptCount++] = instanceIndex;
+    }
+
+    frame.drawList.resize(keptCount);
+    std::sort(selection.begin(), selection.end());
+    frame.impostorSlots.reserve(selection.size());
+
+    for (size_t a = 0; a < selection.size(); ++a) {
+        if (a == 0 || selection[a].first != selection[a - 1].first) {
+            frame.impostorBatches.push_back({ selection[a].first, (int) a, 0 });
+        }
+
+        frame.impostorSlots.push_back(selection[a].second);
+        frame.impostorBatches.back().count++;
+    }
+}
+
+void writeImpostorUniforms(Renderer &renderer, const Frame &frame) {
+    Impostors &impostors = renderer.impostors;
+    impostors.uniformOffsets.clear();
+
+    for (auto &batch : frame.impostorBatches) {
+        const ImpostorAtlas &atlas = impostors.atlases[batch.atlas];
+        ImpostorUniforms uniforms = { glm::vec4(atlas.center, atlas.radius), glm::vec4((float) atlas.gridSize, 0.0f, 0.0f, 0.0f) };
+        impostors.uniformOffsets.push_back(writeUniforms(renderer.uniforms, &uniforms, sizeof(ImpostorUniforms)));
+    }
+}
+
+void drawImpostors(Renderer &renderer, const Frame &frame) {
+    Impostors &impostors = renderer.impostors;
+    Resources &resources = renderer.resources;
+    GlState &state = renderer.state;
+    GLuint program = getResource(resources, impostors.program);
+
+    if (frame.impostorSlots.empty() || !program) {
+        return;
+    }
+
+    // Orphaned every frame like the light buffers, four bytes per far instance is all that goes up
+    bindBuffer(state, GL_ARRAY_BUFFER, getResource(resources, impostors.slotBuffer));
+    glBufferData(GL_ARRAY_BUFFER, frame.impostorSlots.size() * sizeof(GLuint), frame.impostorSlots.data(), GL_STREAM_DRAW);
+    setResourceSize(resources, impostors.slotBuffer, frame.impostorSlots.size() * sizeof(GLuint));
+
+    useProgram(state, program);
+    bindVertexArray(state, getResource(resources, impostors.vao));
+    setCapability(state, GL_DEPTH_TEST, true);
+    setCapability(state, GL_BLEND, false);
+    setColorMask(state, true);
+    setDepthMask(state, true);
+    setDepthFunc(state, GL_LESS);
+
+    for (size_t a = 0; a < frame.impostorBatches.size(); ++a) {
+        const ImpostorBatch &batch = frame.impostorBatches[a];
+        const ImpostorAtlas &atlas = impostors.atlases[batch.atlas];
+
+        if (impostors.uniformOffsets[a] == -1) {
+            continue;
+        }
+
+        bindBufferRange(state, GL_UNIFORM_BUFFER, OBJECT_UNIFORM_BINDING, getResource(resources, renderer.uniforms.buffer), impostors.uniformOffsets[a], sizeof(ImpostorUniforms));
+        bindTexture(state, IMPOSTOR_COLOR_TEXTURE_UNIT, GL_TEXTURE_2D, getResource(resources, atlas.colorTexture));
+        bindTexture(state, IMPOSTOR_NORMAL_TEXTURE_UNIT, GL_TEXTURE_2D, getResource(resources, atlas.normalTexture));
+
+        // Without base instance on a 3.3 context the batch start goes through the attribute offset instead
+        glVertexAttribIPointer(IMPOSTOR_SLOT_LOCATION, 1, GL_UNSIGNED_INT, sizeof(GLuint), (const void*) (uintptr_t) (batch.first * sizeof(GLuint)));
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, batch.count);
+    }
+}
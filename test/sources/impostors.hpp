@@ -0,0 +1,67 @@
+#pragma once
+#include "state.hpp"
+#include "resources.hpp"
+#include <cmath>
+#include <utility>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+const GLuint IMPOSTOR_COLOR_TEXTURE_UNIT = 5;
+const GLuint IMPOSTOR_NORMAL_TEXTURE_UNIT = 6;
+const GLuint IMPOSTOR_SLOT_LOCATION = 0;
+
+struct Model;
+struct Renderer;
+struct Frame;
+
+// A model seen from every direction of an octahedral grid, each cell is one orthographic view of its bounding sphere
+struct ImpostorAtlas {
+    ResourceHandle colorTexture;
+    ResourceHandle normalTexture;
+    int gridSize = 0;
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+};
+
+struct ImpostorUniforms {
+    glm::vec4 bounds;
+    glm::vec4 grid;
+};
+
+// Consecutive far instances sharing one atlas, drawn with a single instanced call
+struct ImpostorBatch {
+    int atlas;
+    int first;
+    int count;
+};
+
+struct Impostors {
+    bool isEnabled = true;
+    float distance = 60.0f;
+    int gridSize = 8;
+    int frameSize = 128;
+    ResourceHandle program;
+    ResourceHandle bakeProgram;
+    ResourceHandle vao;
+    ResourceHandle slotBuffer;
+    std::vector<ImpostorAtlas> atlases;
+    std::vector<std::pair<int, GLuint>> selection;
+    std::vector<GLintptr> uniformOffsets;
+};
+
+glm::vec3 decodeOctahedral(const glm::vec2 &coordinate);
+
+void createImpostors(Impostors &impostors, Resources &resources);
+
+void destroyImpostors(Impostors &impostors, Resources &resources);
+
+int bakeImpostor(Renderer &renderer, Model &model);
+
+void selectImpostors(Renderer &renderer, Frame &frame);
+
+void writeImpostorUniforms(Renderer &renderer, const Frame &frame);
+
+void drawImpostors(Renderer &renderer, const Frame &frame);
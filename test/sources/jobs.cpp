@@ -0,0 +1,112 @@
+#include "jobs.hpp"
+
+void runWorker(Jobs &jobs) {
+    while (true) {
+        std::function<void()> job;
+
+        {
+            std::unique_lock<std::mutex> lock(jobs.mutex);
+            jobs.condition.wait(lock, [&jobs] { return !jobs.isActive || !jobs.queue.empty(); });
+
+            if (!jobs.isActive && jobs.queue.empty()) {
+                return;
+            }
+
+            job = std::move(jobs.queue.front());
+            jobs.queue.pop_front();
+        }
+
+        job();
+    }
+}
+
+void startJobs(Jobs &jobs, unsigned int workerCount) {
+    jobs.isActive = true;
+    jobs.workers.reserve(workerCount);
+
+    for (unsigned int a = 0; a < workerCount; ++a) {
+        jobs.workers.emplace_back(runWorker, std::ref(jobs));
+    }
+}
+
+void stopJobs(Jobs &jobs) {
+    {
+        std::lock_guard<std::mutex> lock(jobs.mutex);
+        jobs.isActive = false;
+    }
+
+    jobs.condition.notify_all();
+
+    for (auto &worker : jobs.workers) {
+        worker.join();
+    }
+
+    jobs.workers.clear();
+}
+
+void submitJob(Jobs &jobs, std::function<void()> job) {
+    if (jobs.workers.empty()) {
+        job();
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(jobs.mutex);
+        jobs.queue.push_back(std::move(job));
+    }
+
+    jobs.condition.notify_one();
+}
+
+bool runPendingJob(Jobs &jobs) {
+    std::function<void()> job;
+
+    {
+        std::lock_guard<std::mutex> lock(jobs.mutex);
+
+        if (jobs.queue.empty()) {
+            return false;
+        }
+
+        job = std::move(jobs.queue.front());
+        jobs.queue.pop_front();
+    }
+
+    job();
+
+    return true;
+}
+
+int getJobConcurrency(const Jobs &jobs) {
+    return (int) jobs.workers.size() + 1;
+}
+
+void parallelFor(Jobs &jobs, int count, const std::function<void(int begin, int end)> &function) {
+    if (count <= 0) {
+        return;
+    }
+
+    int chunkCount = std::min(count, getJobConcurrency(jobs));
+    int chunkSize = (count + chunkCount - 1) / chunkCount;
+    std::atomic<int> remaining(0);
+
+    // Calling thread takes the first chunk and helps with the rest while waiting
+    for (int begin = chunkSize; begin < count; begin += chunkSize) {
+        int end = std::min(begin + chunkSize, count);
+        remaining++;
+
+        submitJob(jobs, [&function, &remaining, begin, end] {
+            function(begin, end);
+            remaining--;
+        });
+    }
+
+    function(0, std::min(chunkSize, count));
+
+    while (remaining > 0) {
+        if (!runPendingJob(jobs)) {
+            std::this_thread::yield();
+        }
+    }
+}
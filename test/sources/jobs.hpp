@@ -0,0 +1,29 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct Jobs {
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> queue;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool isActive = false;
+};
+
+void startJobs(Jobs &jobs, unsigned int workerCount);
+
+void stopJobs(Jobs &jobs);
+
+void submitJob(Jobs &jobs, std::function<void()> job);
+
+bool runPendingJob(Jobs &jobs);
+
+int getJobConcurrency(const Jobs &jobs);
+
+void parallelFor(Jobs &jobs, int count, const std::function<void(int begin, int end)> &function);
@@ -0,0 +1,187 @@
+#include "lighting.hpp"
+
+void createTextureBuffer(Resources &resources, ResourceHandle &buffer, ResourceHandle &texture, GLenum format) {
+    buffer = createResource(resources, ResourceType::Buffer);
+    texture = createResource(resources, ResourceType::Texture);
+    setResourceSize(resources, buffer, 16);
+    glBindBuffer(GL_TEXTURE_BUFFER, getResource(resources, buffer));
+    glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+    glBindTexture(GL_TEXTURE_BUFFER, getResource(resources, texture));
+    glTexBuffer(GL_TEXTURE_BUFFER, format, getResource(resources, buffer));
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void uploadTextureBuffer(Resources &resources, GlState &state, ResourceHandle buffer, const void* data, GLsizeiptr size) {
+    // Orphaned every frame so the driver never has to wait on last frame's reads, never empty so the texture stays valid
+    bindBuffer(state, GL_TEXTURE_BUFFER, getResource(resources, buffer));
+    glBufferData(GL_TEXTURE_BUFFER, std::max(size, (GLsizeiptr) 16), nullptr, GL_STREAM_DRAW);
+    setResourceSize(resources, buffer, std::max(size, (GLsizeiptr) 16));
+
+    if (size > 0) {
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+    }
+}
+
+void createLighting(Lighting &lighting, Resources &resources) {
+    createTextureBuffer(resources, lighting.lightBuffer, lighting.lightTexture, GL_RGBA32F);
+    createTextureBuffer(resources, lighting.rangeBuffer, lighting.rangeTexture, GL_RG32UI);
+    createTextureBuffer(resources, lighting.indexBuffer, lighting.indexTexture, GL_R32UI);
+}
+
+void destroyLighting(Lighting &lighting, Resources &resources) {
+    releaseResource(resources, lighting.lightBuffer);
+    releaseResource(resources, lighting.rangeBuffer);
+    releaseResource(resources, lighting.indexBuffer);
+    releaseResource(resources, lighting.lightTexture);
+    releaseResource(resources, lighting.rangeTexture);
+    releaseResource(resources, lighting.indexTexture);
+}
+
+void bindLightSamplers(GLuint program) {
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "u_Lights"), LIGHT_TEXTURE_UNIT);
+    glUniform1i(glGetUniformLocation(program, "u_LightClusters"), LIGHT_CLUSTER_TEXTURE_UNIT);
+    glUniform1i(glGetUniformLocation(program, "u_LightIndices"), LIGHT_INDEX_TEXTURE_UNIT);
+    glUseProgram(0);
+}
+
+void scatterLights(Lighting &lighting, int count, float extent) {
+    std::mt19937 random(1337);
+    std::uniform_real_distribution<float> position(-extent, extent);
+    std::uniform_real_distribution<float> height(0.5f, 4.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    lighting.lights.resize(count);
+
+    for (auto &light : lighting.lights) {
+        light.position = glm::vec3(position(random), height(random), position(random));
+        light.radius = 1.0f + unit(random) * 4.0f;
+        light.color = glm::vec3(unit(random), unit(random), unit(random));
+        light.intensity = 1.0f;
+    }
+}
+
+int getClusterSlice(float depth, float near, float far, int sliceCount) {
+    int slice = (int) floorf(logf(depth / near) * sliceCount / logf(far / near));
+
+    return std::min(std::max(slice, 0), sliceCount - 1);
+}
+
+LightBounds getLightBounds(const PointLight &light, const glm::ivec3 &clusterCount, const glm::mat4 &projection, const glm::mat4 &view, float near, float far) {
+    LightBounds invisible = { glm::ivec3(0), glm::ivec3(-1) };
+    glm::vec4 center = view * glm::vec4(light.position, 1.0f);
+    float depth = -center.z;
+
+    if (depth + light.radius < near || depth - light.radius > far) {
+        return invisible;
+    }
+
+    LightBounds bounds;
+    bounds.min.z = getClusterSlice(std::max(depth - light.radius, near), near, far, clusterCount.z);
+    bounds.max.z = getClusterSlice(std::min(depth + light.radius, far), near, far, clusterCount.z);
+
+    // A sphere reaching past the near plane can cover any part of the screen
+    if (depth - light.radius < near) {
+        bounds.min.x = bounds.min.y = 0;
+        bounds.max.x = clusterCount.x - 1;
+        bounds.max.y = clusterCount.y - 1;
+
+        return bounds;
+    }
+
+    // Otherwise the projected corners of the view space box enclose the projected sphere
+    glm::vec2 ndcMin = glm::vec2(1.0f);
+    glm::vec2 ndcMax = glm::vec2(-1.0f);
+
+    for (int a = 0; a < 8; ++a) {
+        glm::vec4 corner = center + glm::vec4((a & 1) ? light.radius : -light.radius, (a & 2) ? light.radius : -light.radius, (a & 4) ? light.radius : -light.radius, 0.0f);
+        glm::vec4 clip = projection * corner;
+        glm::vec2 ndc = glm::vec2(clip.x, clip.y) / clip.w;
+        ndcMin = glm::min(ndcMin, ndc);
+        ndcMax = glm::max(ndcMax, ndc);
+    }
+
+    if (ndcMin.x > 1.0f || ndcMin.y > 1.0f || ndcMax.x < -1.0f || ndcMax.y < -1.0f) {
+        return invisible;
+    }
+
+    glm::vec2 tiles = glm::vec2(clusterCount.x, clusterCount.y);
+    glm::ivec2 tileMin = glm::ivec2(glm::floor((ndcMin * 0.5f + 0.5f) * tiles));
+    glm::ivec2 tileMax = glm::ivec2(glm::floor((ndcMax * 0.5f + 0.5f) * tiles));
+    bounds.min.x = std::max(tileMin.x, 0);
+    bounds.min.y = std::max(tileMin.y, 0);
+    bounds.max.x = std::min(tileMax.x, clusterCount.x - 1);
+    bounds.max.y = std::min(tileMax.y, clusterCount.y - 1);
+
+    return bounds;
+}
+
+void assignLights(Lighting &lighting, Jobs &jobs, LightClusters &clusters, const glm::mat4 &projection, const glm::mat4 &view, float near, float far) {
+    glm::ivec3 count = lighting.clusterCount;
+    int clusterTotal = count.x * count.y * count.z;
+    int lightCount = (int) lighting.lights.size();
+
+    clusters.count = glm::vec4(count.x, count.y, count.z, 0.0f);
+    clusters.depth = glm::vec4(count.z / logf(far / near), count.z * logf(near) / logf(far / near), 0.0f, 0.0f);
+    clusters.lights.resize(lightCount * 2);
+
+    for (int a = 0; a < lightCount; ++a) {
+        const PointLight &light = lighting.lights[a];
+        clusters.lights[a * 2] = glm::vec4(light.position, light.radius);
+        clusters.lights[a * 2 + 1] = glm::vec4(light.color, light.intensity);
+    }
+
+    lighting.bounds.resize(lightCount);
+    lighting.clusterLights.resize(clusterTotal * lighting.maxClusterLights);
+    lighting.clusterSizes.assign(clusterTotal, 0);
+
+    parallelFor(jobs, lightCount, [&lighting, &projection, &view, near, far](int begin, int end) {
+        for (int a = begin; a < end; ++a) {
+            lighting.bounds[a] = getLightBounds(lighting.lights[a], lighting.clusterCount, projection, view, near, far);
+        }
+    });
+
+    // Each job owns whole depth slices, so no two jobs ever write the same cluster list
+    parallelFor(jobs, count.z, [&lighting, count, lightCount](int begin, int end) {
+        for (int z = begin; z < end; ++z) {
+            for (int a = 0; a < lightCount; ++a) {
+                const LightBounds &bounds = lighting.bounds[a];
+
+                if (z < bounds.min.z || z > bounds.max.z) {
+                    continue;
+                }
+
+                for (int y = bounds.min.y; y <= bounds.max.y; ++y) {
+                    for (int x = bounds.min.x; x <= bounds.max.x; ++x) {
+                        int cluster = x + count.x * (y + count.y * z);
+                        GLuint &size = lighting.clusterSizes[cluster];
+
+                        if ((int) size < lighting.maxClusterLights) {
+                            lighting.clusterLights[cluster * lighting.maxClusterLights + size++] = a;
+                        }
+                    }
+                }
+            }
+        }
+    });
+
+    clusters.ranges.resize(clusterTotal * 2);
+    clusters.indices.clear();
+
+    for (int a = 0; a < clusterTotal; ++a) {
+        GLuint* lights = &lighting.clusterLights[a * lighting.maxClusterLights];
+        clusters.ranges[a * 2] = (GLuint) clusters.indices.size();
+        clusters.ranges[a * 2 + 1] = lighting.clusterSizes[a];
+        clusters.indices.insert(clusters.indices.end(), lights, lights + lighting.clusterSizes[a]);
+    }
+}
+
+void uploadLights(Lighting &lighting, Resources &resources, GlState &state, const LightClusters &clusters) {
+    uploadTextureBuffer(resources, state, lighting.lightBuffer, clusters.lights.data(), clusters.lights.size() * sizeof(glm::vec4));
+    uploadTextureBuffer(resources, state, lighting.rangeBuffer, clusters.ranges.data(), clusters.ranges.size() * sizeof(GLuint));
+    uploadTextureBuffer(resources, state, lighting.indexBuffer, clusters.indices.data(), clusters.indices.size() * sizeof(GLuint));
+    bindTexture(state, LIGHT_TEXTURE_UNIT, GL_TEXTURE_BUFFER, getResource(resources, lighting.lightTexture));
+    bindTexture(state, LIGHT_CLUSTER_TEXTURE_UNIT, GL_TEXTURE_BUFFER, getResource(resources, lighting.rangeTexture));
+    bindTexture(state, LIGHT_INDEX_TEXTURE_UNIT, GL_TEXTURE_BUFFER, getResource(resources, lighting.indexTexture));
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "jobs.hpp"
+#include "state.hpp"
+#include "resources.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+const GLuint LIGHT_TEXTURE_UNIT = 1;
+const GLuint LIGHT_CLUSTER_TEXTURE_UNIT = 2;
+const GLuint LIGHT_INDEX_TEXTURE_UNIT = 3;
+
+struct PointLight {
+    glm::vec3 position = glm::vec3(0.0f);
+    float radius = 1.0f;
+    glm::vec3 color = glm::vec3(1.0f);
+    float intensity = 1.0f;
+};
+
+struct LightBounds {
+    glm::ivec3 min;
+    glm::ivec3 max;
+};
+
+// Everything the GPU needs for one frame, built on the main thread
+struct LightClusters {
+    std::vector<glm::vec4> lights;
+    std::vector<GLuint> ranges;
+    std::vector<GLuint> indices;
+    glm::vec4 count = glm::vec4(1.0f);
+    glm::vec4 depth = glm::vec4(0.0f);
+};
+
+struct Lighting {
+    std::vector<PointLight> lights;
+    glm::ivec3 clusterCount = glm::ivec3(16, 9, 24);
+    int maxClusterLights = 128;
+    std::vector<LightBounds> bounds;
+    std::vector<GLuint> clusterLights;
+    std::vector<GLuint> clusterSizes;
+    ResourceHandle lightBuffer;
+    ResourceHandle lightTexture;
+    ResourceHandle rangeBuffer;
+    ResourceHandle rangeTexture;
+    ResourceHandle indexBuffer;
+    ResourceHandle indexTexture;
+};
+
+void createLighting(Lighting &lighting, Resources &resources);
+
+void destroyLighting(Lighting &lighting, Resources &resources);
+
+void bindLightSamplers(GLuint program);
+
+void scatterLights(Lighting &lighting, int count, float extent);
+
+void assignLights(Lighting &lighting, Jobs &jobs, LightClusters &clusters, const glm::mat4 &projection, const glm::mat4 &view, float near, float far);
+
+void uploadLights(Lighting &lighting, Resources &resources, GlState &state, const LightClusters &clusters);
@@ -1,6 +1,8 @@
 #include "renderer.hpp"
 #include "gui.hpp"
 #include "scripting.hpp"
+#include "threading.hpp"
+#include "headless.hpp"
 #include <imgui/imgui.h>
 #include <imgui/backends/imgui_impl_sdl.h>
 #include <imgui/backends/imgui_impl_opengl3.h>
@@ -23,8 +25,30 @@ void createProject(const char* name) {
 }
 
 void init(Renderer &renderer) {
-    renderer.shaderProgram = loadShaderProgram("../assets/shaders/main.glsl");
-    renderer.grid = createGrid();
+    startJobs(renderer.jobs, std::max(std::thread::hardware_concurrency(), 2u) - 1);
+    initShaderCache(shaderCache, "../cache/shaders/");
+
+    // Binding a finished variant goes around the state cache, which then has to start over
+    renderer.shaderProgram = createShaderPermutations(renderer.permutations, "../assets/shaders/main.glsl", SHADER_FEATURES_DEFAULT, [&renderer](GLuint program) {
+        bindUniformBlocks(program);
+        bindLightSamplers(program);
+        bindTransformSampler(program);
+        invalidateState(renderer.state);
+    });
+    renderer.depthShaderProgram = adoptResource(renderer.resources, ResourceType::Program, loadShaderProgram("../assets/shaders/depth.glsl"));
+    bindUniformBlocks(getResource(renderer.resources, renderer.depthShaderProgram));
+    bindTransformSampler(getResource(renderer.resources, renderer.depthShaderProgram));
+    createUniformRing(renderer.uniforms, renderer.resources, 1 << 20);
+    createLighting(renderer.lighting, renderer.resources);
+    createTransformBuffer(renderer.transformBuffer, renderer.resources);
+    createVertexPulling(renderer.pulling, renderer.resources);
+    createImpostors(renderer.impostors, renderer.resources);
+    createUploads(renderer.uploads, renderer.resources, 16 << 20);
+    scatterLights(renderer.lighting, 256, 20.0f);
+    renderer.grid = createGrid(renderer.resources);
+
+    // Created up front so the texture name the GUI shows never changes, resizing keeps it
+    resizeRenderTarget(renderer.viewportTarget, renderer.resources, renderer.panelSize);
 
     int width = 128;
     int height = 128;
@@ -40,15 +64,16 @@ void init(Renderer &renderer) {
         }
     }
 
-    GLuint texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    renderer.defaultTexture = createResource(renderer.resources, ResourceType::Texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, getResource(renderer.resources, renderer.defaultTexture));
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB, width, height, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+    setResourceSize(renderer.resources, renderer.defaultTexture, width * height * 3);
 
     updateCamera(renderer.camera);
     // glEnable(GL_CULL_FACE);
@@ -62,13 +87,135 @@ void init(Renderer &renderer) {
     if (modelStatus == -1) {
         std::cout << "Error while loading model" << std::endl;
     } else {
-        bindModel(renderer.models[0]);
+        bindModel(renderer, renderer.models[0]);
+        renderer.models[0].pulledMesh = addPulledModel(renderer.pulling, renderer.resources, renderer.models[0]);
+        loadModelTextures(renderer, renderer.models[0]);
+        createOccluder(renderer.models[0], renderer.maxOccluderTriangles);
+        bakeImpostor(renderer, renderer.models[0]);
+        renderer.instances.push_back({ 0, glm::mat4(1.0f), allocateTransformSlot(renderer.transformSlots, glm::mat4(1.0f)) });
+    }
+
+    // Generated rather than loaded, a box and a sphere either side of the cube
+    GeometryBuilder builder;
+    addBox(builder, glm::vec3(-3.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.5f, 1.0f));
+    addSphere(builder, glm::vec3(3.0f, 0.0f, 0.0f), 1.0f, 32, 16);
+    renderer.models.push_back(Model());
+    Model &primitives = renderer.models.back();
+
+    if (buildModel(primitives, builder, "Primitives") == 0) {
+        bindModel(renderer, primitives);
+        primitives.pulledMesh = addPulledModel(renderer.pulling, renderer.resources, primitives);
+        createOccluder(primitives, renderer.maxOccluderTriangles);
+        renderer.instances.push_back({ (int) renderer.models.size() - 1, glm::mat4(1.0f), allocateTransformSlot(renderer.transformSlots, glm::mat4(1.0f)) });
     }
 
     loadScript("../assets/scripts/main.lua");
+
+    // Everything above binds through raw GL calls, so the state cache starts from scratch
+    invalidateState(renderer.state);
+}
+
+void destroy(Renderer &renderer) {
+    Resources &resources = renderer.resources;
+    stopJobs(renderer.jobs);
+    destroyUniformRing(renderer.uniforms, resources);
+    destroyProfiler(renderer.profiler);
+    destroyFrameGraph(renderer.frameGraph, resources);
+    destroyRenderTarget(renderer.viewportTarget, resources);
+    destroyLighting(renderer.lighting, resources);
+    destroyTextureStreaming(renderer.streaming, resources);
+    destroyShaderPermutations(renderer.permutations);
+    destroyTransformBuffer(renderer.transformBuffer, resources);
+    destroyVertexPulling(renderer.pulling, resources);
+    destroyImpostors(renderer.impostors, resources);
+    destroyUploads(renderer.uploads, resources);
+
+    for (auto &model : renderer.models) {
+        destroyModel(model, resources);
+    }
+
+    releaseResource(resources, renderer.grid.shaderProgram);
+    releaseResource(resources, renderer.grid.vao);
+    releaseResource(resources, renderer.depthShaderProgram);
+    releaseResource(resources, renderer.defaultTexture);
+    destroyResources(resources);
+}
+
+int runHeadless(int argc, char* argv[]) {
+    HeadlessOptions options;
+    HeadlessContext headless;
+
+    if (parseHeadlessOptions(options, argc, argv) == -1 || createHeadlessContext(headless) == -1) {
+        return -1;
+    }
+
+    entt::registry registry;
+    entt::observer transformObserver(registry, entt::collector.group<Transform>().update<Transform>());
+    Renderer renderer;
+    registry.on_destroy<TransformSlot>().connect<&releaseTransformSlot>(renderer.transformSlots);
+    lua::registry = &registry;
+    init(renderer);
+
+    if (resizeRenderTarget(headless.target, renderer.resources, options.size) == -1) {
+        destroy(renderer);
+        destroyHeadlessContext(headless);
+
+        return -1;
+    }
+
+    renderer.viewport = options.size;
+    renderer.outputFramebuffer = getResource(renderer.resources, headless.target.framebuffer);
+
+    Frame frame;
+    HeadlessTimings timings;
+    int imageInterval = options.imageInterval > 0 ? options.imageInterval : options.frameCount;
+
+    for (int a = 0; a < options.frameCount; ++a) {
+        auto start = std::chrono::steady_clock::now();
+        syncTransforms(renderer, registry, transformObserver);
+        buildFrame(renderer, frame);
+        beginProfilerFrame(renderer.profiler);
+        int frameScope = beginGpuScope(renderer.profiler, "Frame");
+        renderFrame(renderer, frame);
+        endGpuScope(renderer.profiler, frameScope);
+        frame.stats.timings = getGpuTimings(renderer.profiler);
+        renderer.stats = frame.stats;
+
+        // Finishing each frame makes the wall time comparable across drivers, software ones included
+        glFinish();
+        timings.frameMilliseconds.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+        timings.gpuTimings.push_back(frame.stats.timings);
+
+        for (auto &timing : timings.gpuTimings.back()) {
+            timing.history.clear();
+        }
+
+        if (!options.imagePrefix.empty() && (a + 1) % imageInterval == 0) {
+            writeFrameImage(headless, renderer.resources, options.imagePrefix + "_" + std::to_string(a + 1) + ".png");
+        }
+    }
+
+    int status = options.timingsPath.empty() ? 0 : writeHeadlessTimings(options, timings);
+    destroyRenderTarget(headless.target, renderer.resources);
+    destroy(renderer);
+    destroyHeadlessContext(headless);
+
+    return status;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    bool isThreaded = false;
+
+    for (int a = 1; a < argc; ++a) {
+        if (std::string(argv[a]) == "--render-thread") {
+            isThreaded = true;
+        }
+
+        if (std::string(argv[a]) == "--headless") {
+            return runHeadless(argc, argv);
+        }
+    }
+
     // Initialize SDL
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_GAMECONTROLLER) != 0) {
         std::cout << "Error: " << SDL_GetError() << std::endl;
@@ -79,7 +226,7 @@ int main() {
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, 0);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
     SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
     SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
     SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, 8);
@@ -104,23 +251,40 @@ int main() {
     // Initialize ImGui
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
+    ImPlot::CreateContext();
     ImGui::StyleColorsLight();
+
+#ifdef IMGUI_HAS_DOCK
+    ImGui::GetIO().ConfigFlags |= ImGuiConfigFlags_DockingEnable;
+#endif
+
     ImGui_ImplSDL2_InitForOpenGL(window, glContext);
     ImGui_ImplOpenGL3_Init("#version 130");
 
     // Initialize engine
     bool isActive = true;
-    Uint32 lastTick = 0;
     float deltaTick = 0.0f;
+    FramePacing pacing;
     entt::registry registry;
+    entt::observer transformObserver(registry, entt::collector.group<Transform>().update<Transform>());
     Renderer renderer;
+    registry.on_destroy<TransformSlot>().connect<&releaseTransformSlot>(renderer.transformSlots);
     lua::registry = &registry;
     init(renderer);
 
+    // In threaded mode the render thread owns the context, main thread simulates and builds the next frame meanwhile
+    Frame frame;
+    RenderThread renderThread;
+
+    if (isThreaded) {
+        ImGui_ImplOpenGL3_CreateDeviceObjects();
+        startRenderThread(renderThread, window, glContext, renderer);
+    }
+
+    startPacing(pacing);
+
     while (isActive) {
-        Uint32 tick = SDL_GetTicks();
-        deltaTick = (tick - lastTick) / 1000.0f;
-        lastTick = tick;
+        deltaTick = beginPacedFrame(pacing);
 
         SDL_Event event;
 
@@ -154,15 +318,35 @@ int main() {
         ImGui_ImplSDL2_NewFrame();
         ImGui::NewFrame();
         renderGui(registry, renderer);
+        renderPacing(pacing);
         ImGui::Render();
-        draw(window, renderer);
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-        SDL_GL_SwapWindow(window);
+        SDL_GL_GetDrawableSize(window, &renderer.windowSize.x, &renderer.windowSize.y);
+        renderer.viewport = renderer.isViewportPanel ? renderer.panelSize : renderer.windowSize;
+        renderer.swapInterval = getSwapInterval(pacing);
+        syncTransforms(renderer, registry, transformObserver);
+
+        if (isThreaded) {
+            buildFrame(renderer, getWriteFrame(renderThread));
+            captureGui(getWriteGui(renderThread), ImGui::GetDrawData());
+            submitFrame(renderThread, renderer);
+        } else {
+            buildFrame(renderer, frame);
+            presentFrame(window, renderer, frame, nullptr);
+            renderer.stats = frame.stats;
+        }
+
+        limitFrameRate(pacing);
     }
 
     // Clean up
+    if (isThreaded) {
+        stopRenderThread(renderThread);
+    }
+
+    destroy(renderer);
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL2_Shutdown();
+    ImPlot::DestroyContext();
     ImGui::DestroyContext();
     SDL_GL_DeleteContext(glContext);
     SDL_DestroyWindow(window);
@@ -0,0 +1,89 @@
+#include "pacing.hpp"
+
+void startPacing(FramePacing &pacing) {
+    pacing.frequency = SDL_GetPerformanceFrequency();
+    pacing.frameStart = SDL_GetPerformanceCounter();
+}
+
+float beginPacedFrame(FramePacing &pacing) {
+    Uint64 counter = SDL_GetPerformanceCounter();
+    pacing.deltaTime = (float) ((double) (counter - pacing.frameStart) / pacing.frequency);
+    pacing.frameStart = counter;
+
+    pacing.history[pacing.historyOffset] = pacing.deltaTime * 1000.0f;
+    pacing.historyOffset = (pacing.historyOffset + 1) % PACING_HISTORY;
+    pacing.historyCount = std::min(pacing.historyCount + 1, PACING_HISTORY);
+
+    return pacing.deltaTime;
+}
+
+void limitFrameRate(FramePacing &pacing) {
+    if (pacing.mode != PacingMode::Limited || pacing.targetRate <= 0.0f) {
+        return;
+    }
+
+    Uint64 deadline = pacing.frameStart + (Uint64) (pacing.frequency / pacing.targetRate);
+    Uint64 spin = (Uint64) (pacing.frequency * pacing.spinMilliseconds / 1000.0f);
+
+    // Sleep is only accurate to the scheduler tick, so it stops short and the remainder is spun out
+    while (true) {
+        Uint64 counter = SDL_GetPerformanceCounter();
+
+        if (counter + spin >= deadline) {
+            break;
+        }
+
+        SDL_Delay((Uint32) std::max((deadline - spin - counter) * 1000 / pacing.frequency, (Uint64) 1));
+    }
+
+    while (SDL_GetPerformanceCounter() < deadline) {
+    }
+}
+
+int getSwapInterval(const FramePacing &pacing) {
+    switch (pacing.mode) {
+        case PacingMode::Vsync: return 1;
+        case PacingMode::AdaptiveVsync: return -1;
+        case PacingMode::Uncapped: return 0;
+        case PacingMode::Limited: return 0;
+    }
+
+    return 1;
+}
+
+std::vector<float> getPacingHistory(const FramePacing &pacing) {
+    std::vector<float> history;
+    history.reserve(pacing.historyCount);
+
+    for (int a = PACING_HISTORY - pacing.historyCount; a < PACING_HISTORY; ++a) {
+        history.push_back(pacing.history[(pacing.historyOffset + a) % PACING_HISTORY]);
+    }
+
+    return history;
+}
+
+PacingStats getPacingStats(const FramePacing &pacing) {
+    PacingStats stats;
+    std::vector<float> history = getPacingHistory(pacing);
+
+    if (history.empty()) {
+        return stats;
+    }
+
+    for (auto milliseconds : history) {
+        stats.average += milliseconds;
+    }
+
+    stats.average /= history.size();
+
+    for (auto milliseconds : history) {
+        stats.deviation += (milliseconds - stats.average) * (milliseconds - stats.average);
+    }
+
+    stats.deviation = sqrtf(stats.deviation / history.size());
+    std::sort(history.begin(), history.end());
+    stats.percentile99 = history[std::min((size_t) (history.size() * 0.99f), history.size() - 1)];
+    stats.maximum = history.back();
+
+    return stats;
+}
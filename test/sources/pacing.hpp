@@ -0,0 +1,45 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <SDL2/SDL.h>
+
+const int PACING_HISTORY = 600;
+
+enum class PacingMode : int {
+    Vsync,
+    AdaptiveVsync,
+    Uncapped,
+    Limited
+};
+
+struct PacingStats {
+    float average = 0.0f;
+    float deviation = 0.0f;
+    float percentile99 = 0.0f;
+    float maximum = 0.0f;
+};
+
+struct FramePacing {
+    PacingMode mode = PacingMode::Vsync;
+    float targetRate = 60.0f;
+    float spinMilliseconds = 2.0f;
+    Uint64 frequency = 0;
+    Uint64 frameStart = 0;
+    float deltaTime = 0.0f;
+    float history[PACING_HISTORY] = {};
+    int historyOffset = 0;
+    int historyCount = 0;
+};
+
+void startPacing(FramePacing &pacing);
+
+float beginPacedFrame(FramePacing &pacing);
+
+void limitFrameRate(FramePacing &pacing);
+
+int getSwapInterval(const FramePacing &pacing);
+
+std::vector<float> getPacingHistory(const FramePacing &pacing);
+
+PacingStats getPacingStats(const FramePacing &pacing);
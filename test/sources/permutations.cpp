@@ -0,0 +1,189 @@
+#include "renderer.hpp"
+
+const char* SHADER_FEATURE_NAMES[SHADER_FEATURE_COUNT] = { "TEXTURED", "SUN_LIGHT", "CLUSTERED_LIGHTS", "VERTEX_PULLING" };
+
+ShaderDefines getFeatureDefines(uint32_t features) {
+    ShaderDefines defines;
+
+    for (int a = 0; a < SHADER_FEATURE_COUNT; ++a) {
+        if (features & (1u << a)) {
+            defines.push_back({ std::string("FEATURE_") + SHADER_FEATURE_NAMES[a], "1" });
+        }
+    }
+
+    return defines;
+}
+
+GLuint createShaderPermutations(ShaderPermutations &permutations, const std::string &path, uint32_t fallbackFeatures, std::function<void(GLuint)> prepareProgram) {
+    permutations.path = path;
+    permutations.fallbackFeatures = fallbackFeatures;
+    permutations.prepareProgram = prepareProgram;
+
+    // Let the driver use as many compiler threads as it wants
+    if (GLAD_GL_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    }
+
+    // Drawing always needs something, so the fallback is compiled up front
+    GLuint program = loadShaderProgram(path, getFeatureDefines(fallbackFeatures));
+
+    if (!program) {
+        return GL_FALSE;
+    }
+
+    ShaderVariant &variant = permutations.variants[fallbackFeatures];
+    variant.program = program;
+    variant.isReady = true;
+    permutations.prepareProgram(program);
+
+    return program;
+}
+
+void printInfoLog(GLuint object, bool isProgram) {
+    GLint length = 0;
+    isProgram ? glGetProgramiv(object, GL_INFO_LOG_LENGTH, &length) : glGetShaderiv(object, GL_INFO_LOG_LENGTH, &length);
+
+    if (length <= 0) {
+        return;
+    }
+
+    std::vector<char> infoLog(length);
+    isProgram ? glGetProgramInfoLog(object, length, &length, infoLog.data()) : glGetShaderInfoLog(object, length, &length, infoLog.data());
+
+    std::cout << infoLog.data() << std::endl;
+}
+
+void startShaderVariant(ShaderPermutations &permutations, ShaderVariant &variant, uint32_t features) {
+    ShaderDefines defines = getFeatureDefines(features);
+    PreprocessedShader shader;
+
+    if (preprocessShader(shader, shaderCache.files, permutations.path, defines) == -1) {
+        variant.isFailed = true;
+
+        return;
+    }
+
+    if (shaderCache.isEnabled) {
+        variant.key = hashProgramSources(shaderCache, shader.stages, joinShaderDefines(defines));
+        variant.program = loadCachedProgram(shaderCache, variant.key);
+
+        if (variant.program) {
+            shaderCache.hitCount++;
+            variant.isReady = true;
+            permutations.prepareProgram(variant.program);
+
+            return;
+        }
+
+        shaderCache.missCount++;
+    }
+
+    // Nothing here queries a status, so with parallel compile the driver works on it in the background
+    variant.program = glCreateProgram();
+
+    for (auto &[type, source] : shader.stages) {
+        const GLchar* text = source.c_str();
+        GLuint object = glCreateShader(getShaderType(type));
+        glShaderSource(object, 1, &text, nullptr);
+        glCompileShader(object);
+        glAttachShader(variant.program, object);
+        variant.shaders.push_back(object);
+    }
+
+    if (GLAD_GL_ARB_get_program_binary) {
+        glProgramParameteri(variant.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    glLinkProgram(variant.program);
+    permutations.pendingCount++;
+}
+
+bool isShaderVariantComplete(ShaderVariant &variant) {
+    if (GLAD_GL_KHR_parallel_shader_compile) {
+        GLint isComplete = GL_FALSE;
+        glGetProgramiv(variant.program, GL_COMPLETION_STATUS_KHR, &isComplete);
+
+        return isComplete;
+    }
+
+    // Without the extension there is no way to ask, so give drivers that compile on their own threads a frame
+    return ++variant.waitedFrames > 1;
+}
+
+void finishShaderVariant(ShaderPermutations &permutations, ShaderVariant &variant) {
+    GLint linkStatus = GL_FALSE;
+    glGetProgramiv(variant.program, GL_LINK_STATUS, &linkStatus);
+    permutations.pendingCount--;
+
+    if (!linkStatus) {
+        for (auto object : variant.shaders) {
+            printInfoLog(object, false);
+        }
+
+        printInfoLog(variant.program, true);
+    }
+
+    for (auto object : variant.shaders) {
+        glDetachShader(variant.program, object);
+        glDeleteShader(object);
+    }
+
+    variant.shaders.clear();
+
+    if (!linkStatus) {
+        glDeleteProgram(variant.program);
+        variant.program = GL_FALSE;
+        variant.isFailed = true;
+
+        return;
+    }
+
+    if (shaderCache.isEnabled) {
+        storeCachedProgram(shaderCache, variant.key, variant.program);
+    }
+
+    variant.isReady = true;
+    permutations.prepareProgram(variant.program);
+}
+
+GLuint getShaderVariant(ShaderPermutations &permutations, uint32_t features) {
+    auto found = permutations.variants.find(features);
+
+    if (found == permutations.variants.end()) {
+        found = permutations.variants.emplace(features, ShaderVariant()).first;
+        startShaderVariant(permutations, found->second, features);
+    }
+
+    ShaderVariant &variant = found->second;
+
+    if (!variant.isReady && !variant.isFailed && isShaderVariantComplete(variant)) {
+        finishShaderVariant(permutations, variant);
+    }
+
+    if (variant.isReady) {
+        return variant.program;
+    }
+
+    return permutations.variants[permutations.fallbackFeatures].program;
+}
+
+bool isShaderVariantReady(const ShaderPermutations &permutations, uint32_t features) {
+    auto found = permutations.variants.find(features);
+
+    return found != permutations.variants.end() && found->second.isReady;
+}
+
+void destroyShaderPermutations(ShaderPermutations &permutations) {
+    for (auto &[features, variant] : permutations.variants) {
+        for (auto object : variant.shaders) {
+            glDeleteShader(object);
+        }
+
+        if (variant.program) {
+            glDeleteProgram(variant.program);
+        }
+    }
+
+    permutations.variants.clear();
+    permutations.pendingCount = 0;
+}
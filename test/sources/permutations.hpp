@@ -0,0 +1,47 @@
+#pragma once
+#include <iostream>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "preprocessor.hpp"
+
+enum ShaderFeature : uint32_t {
+    SHADER_FEATURE_TEXTURED = 1 << 0,
+    SHADER_FEATURE_SUN_LIGHT = 1 << 1,
+    SHADER_FEATURE_CLUSTERED_LIGHTS = 1 << 2,
+    SHADER_FEATURE_VERTEX_PULLING = 1 << 3
+};
+
+const int SHADER_FEATURE_COUNT = 4;
+const uint32_t SHADER_FEATURES_DEFAULT = SHADER_FEATURE_TEXTURED | SHADER_FEATURE_SUN_LIGHT | SHADER_FEATURE_CLUSTERED_LIGHTS;
+extern const char* SHADER_FEATURE_NAMES[SHADER_FEATURE_COUNT];
+
+struct ShaderVariant {
+    GLuint program = GL_FALSE;
+    std::vector<GLuint> shaders;
+    uint64_t key = 0;
+    bool isReady = false;
+    bool isFailed = false;
+    int waitedFrames = 0;
+};
+
+struct ShaderPermutations {
+    std::string path;
+    std::map<uint32_t, ShaderVariant> variants;
+    uint32_t fallbackFeatures = 0;
+    std::function<void(GLuint)> prepareProgram;
+    int pendingCount = 0;
+};
+
+ShaderDefines getFeatureDefines(uint32_t features);
+
+GLuint createShaderPermutations(ShaderPermutations &permutations, const std::string &path, uint32_t fallbackFeatures, std::function<void(GLuint)> prepareProgram);
+
+GLuint getShaderVariant(ShaderPermutations &permutations, uint32_t features);
+
+bool isShaderVariantReady(const ShaderPermutations &permutations, uint32_t features);
+
+void destroyShaderPermutations(ShaderPermutations &permutations);
@@ -0,0 +1,156 @@
+#include "preprocessor.hpp"
+
+const int MAX_INCLUDE_DEPTH = 32;
+
+struct PreprocessContext {
+    PreprocessedShader &shader;
+    ShaderFiles &files;
+    const ShaderDefines &defines;
+    std::string* stage = nullptr;
+    std::set<std::string> expanding;
+};
+
+const std::string* readShaderFile(ShaderFiles &files, const std::string &path) {
+    auto cached = files.contents.find(path);
+
+    if (cached != files.contents.end()) {
+        return &cached->second;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file.is_open()) {
+        return nullptr;
+    }
+
+    std::stringstream stream;
+    stream << file.rdbuf();
+
+    return &files.contents.emplace(path, stream.str()).first->second;
+}
+
+std::string joinShaderDefines(const ShaderDefines &defines) {
+    std::string joined;
+
+    for (auto &[name, value] : defines) {
+        joined += "#define " + name + " " + value + "\n";
+    }
+
+    return joined;
+}
+
+bool consumeDirective(std::string_view &line, const char* directive) {
+    size_t length = strlen(directive);
+
+    if (line.compare(0, length, directive) != 0 || (line.size() > length && line[length] != ' ' && line[length] != '\t')) {
+        return false;
+    }
+
+    line.remove_prefix(length);
+    size_t first = line.find_first_not_of(" \t");
+    line.remove_prefix(first == std::string_view::npos ? line.size() : first);
+
+    return true;
+}
+
+void appendLineMarker(std::string &stage, int line, int file) {
+    stage += "#line " + std::to_string(line) + " " + std::to_string(file) + "\n";
+}
+
+int appendShaderFile(PreprocessContext &context, const std::string &path, int depth) {
+    if (depth > MAX_INCLUDE_DEPTH) {
+        std::cout << "Shader include depth exceeded at " << path << std::endl;
+
+        return -1;
+    }
+
+    const std::string* text = readShaderFile(context.files, path);
+
+    if (!text) {
+        std::cout << "Failed to open shader file " << path << std::endl;
+
+        return -1;
+    }
+
+    // Source string numbers in #line markers index this list, so driver errors point at the right file
+    auto &shaderFiles = context.shader.files;
+    int file = (int) (std::find(shaderFiles.begin(), shaderFiles.end(), path) - shaderFiles.begin());
+
+    if (file == (int) shaderFiles.size()) {
+        shaderFiles.push_back(path);
+    }
+
+    if (depth > 0 && context.stage) {
+        appendLineMarker(*context.stage, 1, file);
+    }
+
+    const char* cursor = text->data();
+    const char* end = cursor + text->size();
+    int line = 1;
+
+    while (cursor < end) {
+        const char* lineEnd = (const char*) memchr(cursor, '\n', end - cursor);
+        lineEnd = lineEnd ? lineEnd : end;
+        std::string_view view(cursor, lineEnd - cursor);
+        size_t first = view.find_first_not_of(" \t");
+
+        if (first != std::string_view::npos && view[first] == '#') {
+            std::string_view directive = view.substr(first + 1);
+
+            if (depth == 0 && consumeDirective(directive, "type")) {
+                context.stage = &context.shader.stages[std::string(directive.substr(0, directive.find_last_not_of(" \t\r") + 1))];
+            } else if (consumeDirective(directive, "include")) {
+                size_t open = directive.find('"');
+                size_t close = directive.find('"', open + 1);
+
+                if (open == std::string_view::npos || close == std::string_view::npos || !context.stage) {
+                    std::cout << path << ":" << line << ": invalid #include" << std::endl;
+
+                    return -1;
+                }
+
+                std::string includePath = (std::filesystem::path(path).parent_path() / std::string(directive.substr(open + 1, close - open - 1))).lexically_normal().string();
+
+                // Guarded in the output, so the GLSL preprocessor decides and an include under #ifdef can't swallow one under #else
+                if (context.expanding.insert(includePath).second) {
+                    auto guarded = std::find(shaderFiles.begin(), shaderFiles.end(), includePath);
+                    std::string guard = "SHADER_INCLUDE_" + std::to_string(guarded - shaderFiles.begin());
+                    context.stage->append("#ifndef " + guard + "\n#define " + guard + "\n");
+
+                    if (appendShaderFile(context, includePath, depth + 1) == -1) {
+                        return -1;
+                    }
+
+                    context.stage->append("#endif\n");
+                    context.expanding.erase(includePath);
+                    appendLineMarker(*context.stage, line + 1, file);
+                }
+            } else if (context.stage && consumeDirective(directive, "version")) {
+                context.stage->append(cursor, lineEnd - cursor);
+                context.stage->push_back('\n');
+                context.stage->append(joinShaderDefines(context.defines));
+                appendLineMarker(*context.stage, line + 1, file);
+            } else if (context.stage) {
+                context.stage->append(cursor, lineEnd - cursor);
+                context.stage->push_back('\n');
+            }
+        } else if (context.stage) {
+            context.stage->append(cursor, lineEnd - cursor);
+            context.stage->push_back('\n');
+        }
+
+        cursor = lineEnd + 1;
+        line++;
+    }
+
+    return 0;
+}
+
+int preprocessShader(PreprocessedShader &shader, ShaderFiles &files, const std::string &path, const ShaderDefines &defines) {
+    shader.stages.clear();
+    shader.files.clear();
+
+    PreprocessContext context = { shader, files, defines };
+
+    return appendShaderFile(context, path, 0);
+}
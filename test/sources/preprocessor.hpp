@@ -0,0 +1,31 @@
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <cstring>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using ShaderDefines = std::vector<std::pair<std::string, std::string>>;
+
+// File contents by path, read once and shared by every program that includes them
+struct ShaderFiles {
+    std::map<std::string, std::string> contents;
+};
+
+struct PreprocessedShader {
+    std::map<std::string, std::string> stages;
+    std::vector<std::string> files;
+};
+
+const std::string* readShaderFile(ShaderFiles &files, const std::string &path);
+
+std::string joinShaderDefines(const ShaderDefines &defines);
+
+int preprocessShader(PreprocessedShader &shader, ShaderFiles &files, const std::string &path, const ShaderDefines &defines);
@@ -0,0 +1,106 @@
+#include "profiler.hpp"
+
+void beginProfilerFrame(Profiler &profiler) {
+    profiler.frame = (profiler.frame + 1) % PROFILER_LATENCY;
+    profiler.stack.clear();
+
+    // Results are read only once available, a query still in flight is simply checked again next frame
+    for (auto &scope : profiler.scopes) {
+        for (int a = 0; a < PROFILER_LATENCY; ++a) {
+            if (!scope.isPending[a]) {
+                continue;
+            }
+
+            GLuint isAvailable = GL_FALSE;
+            glGetQueryObjectuiv(scope.endQueries[a], GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+
+            if (isAvailable) {
+                GLuint64 beginTime = 0;
+                GLuint64 endTime = 0;
+                glGetQueryObjectui64v(scope.beginQueries[a], GL_QUERY_RESULT, &beginTime);
+                glGetQueryObjectui64v(scope.endQueries[a], GL_QUERY_RESULT, &endTime);
+                scope.milliseconds = (endTime - beginTime) / 1000000.0f;
+                scope.history[scope.historyOffset] = scope.milliseconds;
+                scope.historyOffset = (scope.historyOffset + 1) % PROFILER_HISTORY;
+                scope.isPending[a] = false;
+            }
+        }
+    }
+}
+
+int beginGpuScope(Profiler &profiler, const std::string &name) {
+    int index = -1;
+
+    for (int a = 0; a < (int) profiler.scopes.size(); ++a) {
+        if (profiler.scopes[a].name == name) {
+            index = a;
+
+            break;
+        }
+    }
+
+    if (index == -1) {
+        GpuScope scope;
+        scope.name = name;
+        scope.depth = (int) profiler.stack.size();
+        glGenQueries(PROFILER_LATENCY, scope.beginQueries);
+        glGenQueries(PROFILER_LATENCY, scope.endQueries);
+        profiler.scopes.push_back(scope);
+        index = (int) profiler.scopes.size() - 1;
+    }
+
+    GpuScope &scope = profiler.scopes[index];
+
+    // A slot still in flight is skipped rather than waited on
+    if (scope.isPending[profiler.frame]) {
+        return -1;
+    }
+
+    // Timestamps rather than elapsed time queries, so scopes can nest
+    glQueryCounter(scope.beginQueries[profiler.frame], GL_TIMESTAMP);
+    profiler.stack.push_back(index);
+
+    return index;
+}
+
+void endGpuScope(Profiler &profiler, int scope) {
+    if (scope == -1 || profiler.stack.empty() || profiler.stack.back() != scope) {
+        return;
+    }
+
+    glQueryCounter(profiler.scopes[scope].endQueries[profiler.frame], GL_TIMESTAMP);
+    profiler.scopes[scope].isPending[profiler.frame] = true;
+    profiler.stack.pop_back();
+}
+
+std::vector<GpuTiming> getGpuTimings(const Profiler &profiler) {
+    std::vector<GpuTiming> timings;
+    timings.reserve(profiler.scopes.size());
+
+    for (auto &scope : profiler.scopes) {
+        GpuTiming timing;
+        timing.name = scope.name;
+        timing.depth = scope.depth;
+        timing.milliseconds = scope.milliseconds;
+        timing.history.reserve(PROFILER_HISTORY);
+
+        // Unrolled oldest first so the plot doesn't need the ring offset
+        for (int a = 0; a < PROFILER_HISTORY; ++a) {
+            timing.history.push_back(scope.history[(scope.historyOffset + a) % PROFILER_HISTORY]);
+        }
+
+        timings.push_back(timing);
+    }
+
+    return timings;
+}
+
+void destroyProfiler(Profiler &profiler) {
+    for (auto &scope : profiler.scopes) {
+        glDeleteQueries(PROFILER_LATENCY, scope.beginQueries);
+        glDeleteQueries(PROFILER_LATENCY, scope.endQueries);
+    }
+
+    profiler.scopes.clear();
+    profiler.stack.clear();
+}
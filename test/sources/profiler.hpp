@@ -0,0 +1,41 @@
+#pragma once
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+
+const int PROFILER_LATENCY = 4;
+const int PROFILER_HISTORY = 240;
+
+struct GpuTiming {
+    std::string name;
+    int depth = 0;
+    float milliseconds = 0.0f;
+    std::vector<float> history;
+};
+
+struct GpuScope {
+    std::string name;
+    int depth = 0;
+    GLuint beginQueries[PROFILER_LATENCY] = {};
+    GLuint endQueries[PROFILER_LATENCY] = {};
+    bool isPending[PROFILER_LATENCY] = {};
+    float milliseconds = 0.0f;
+    float history[PROFILER_HISTORY] = {};
+    int historyOffset = 0;
+};
+
+struct Profiler {
+    std::vector<GpuScope> scopes;
+    std::vector<int> stack;
+    int frame = 0;
+};
+
+void beginProfilerFrame(Profiler &profiler);
+
+int beginGpuScope(Profiler &profiler, const std::string &name);
+
+void endGpuScope(Profiler &profiler, int scope);
+
+std::vector<GpuTiming> getGpuTimings(const Profiler &profiler);
+
+void destroyProfiler(Profiler &profiler);
@@ -0,0 +1,202 @@
+#include "renderer.hpp"
+
+void createVertexPulling(VertexPulling &pulling, Resources &resources) {
+    // Storage buffers, indirect multi-draw and base instances are all GL 4.3 core, older contexts may still expose them
+    pulling.isSupported = GLAD_GL_ARB_shader_storage_buffer_object && GLAD_GL_ARB_shading_language_420pack && GLAD_GL_ARB_draw_indirect && GLAD_GL_ARB_multi_draw_indirect && GLAD_GL_ARB_base_instance;
+
+    if (!pulling.isSupported) {
+        return;
+    }
+
+    pulling.vertexBuffer = createResource(resources, ResourceType::Buffer);
+    pulling.layoutBuffer = createResource(resources, ResourceType::Buffer);
+    pulling.indexBuffer = createResource(resources, ResourceType::Buffer);
+    pulling.drawBuffer = createResource(resources, ResourceType::Buffer);
+    pulling.indirectBuffer = createResource(resources, ResourceType::Buffer);
+
+    // The only vertex array the pulled path needs, its one attribute is the per-draw data
+    pulling.vao = createResource(resources, ResourceType::VertexArray);
+    glBindVertexArray(getResource(resources, pulling.vao));
+    glBindBuffer(GL_ARRAY_BUFFER, getResource(resources, pulling.drawBuffer));
+    glEnableVertexAttribArray(PULLED_DRAW_LOCATION);
+    glVertexAttribIPointer(PULLED_DRAW_LOCATION, 4, GL_UNSIGNED_INT, sizeof(glm::uvec4), nullptr);
+    glVertexAttribDivisor(PULLED_DRAW_LOCATION, 1);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, getResource(resources, pulling.indexBuffer));
+    glBindVertexArray(0);
+}
+
+void destroyVertexPulling(VertexPulling &pulling, Resources &resources) {
+    releaseResource(resources, pulling.vertexBuffer);
+    releaseResource(resources, pulling.layoutBuffer);
+    releaseResource(resources, pulling.indexBuffer);
+    releaseResource(resources, pulling.drawBuffer);
+    releaseResource(resources, pulling.indirectBuffer);
+    releaseResource(resources, pulling.vao);
+}
+
+bool isPullableAccessor(const Model &model, const Accessor &accessor) {
+    int size = getComponentSize(accessor.componentType);
+    bool isSupported = accessor.componentType == GL_FLOAT || accessor.componentType == GL_SHORT || accessor.componentType == GL_UNSIGNED_SHORT;
+
+    return isSupported && accessor.byteOffset % size == 0 && getAccessorStride(model, accessor) % size == 0;
+}
+
+int addPulledModel(VertexPulling &pulling, Resources &resources, const Model &model) {
+    if (!pulling.isSupported) {
+        return -1;
+    }
+
+    const MeshPrimitive* meshPrimitive = nullptr;
+
+    // A pulled model skips its whole vertex array path, so it has to come down to exactly one primitive
+    for (auto nodeIndex : model.scenes[model.scene].nodes) {
+        const Node &node = model.nodes[nodeIndex];
+
+        if (node.mesh > -1 && !isOccluderMesh(model.meshes[node.mesh])) {
+            const Mesh &mesh = model.meshes[node.mesh];
+
+            if (meshPrimitive || mesh.primitives.size() != 1) {
+                return -1;
+            }
+
+            meshPrimitive = &mesh.primitives[0];
+        }
+    }
+
+    if (!meshPrimitive) {
+        return -1;
+    }
+
+    const char* keys[] = { "POSITION", "NORMAL", "TEXCOORD_0" };
+    int accessors[3];
+
+    for (int a = 0; a < 3; ++a) {
+        accessors[a] = findAttribute(*meshPrimitive, keys[a]);
+
+        // Anything the shader can't decode keeps the model on the vertex array path
+        if (accessors[a] != -1 && !isPullableAccessor(model, model.accessors[accessors[a]])) {
+            return -1;
+        }
+    }
+
+    if (accessors[0] == -1) {
+        return -1;
+    }
+
+    // Each view is copied once, word aligned, interleaved attributes then share it like they do in the model
+    PulledLayout layout;
+    std::map<int, size_t> viewOffsets;
+
+    for (int a = 0; a < 3; ++a) {
+        if (accessors[a] == -1) {
+            continue;
+        }
+
+        const Accessor &accessor = model.accessors[accessors[a]];
+        const BufferView &bufferView = model.bufferViews[accessor.bufferView];
+        auto found = viewOffsets.find(accessor.bufferView);
+
+        if (found == viewOffsets.end()) {
+            size_t offset = (pulling.vertexData.size() + 3) & ~(size_t) 3;
+            pulling.vertexData.resize(offset + bufferView.byteLength);
+            memcpy(pulling.vertexData.data() + offset, model.buffer.data() + bufferView.byteOffset, bufferView.byteLength);
+            found = viewOffsets.emplace(accessor.bufferView, offset).first;
+        }
+
+        layout.offsets[a] = (GLuint) (found->second + accessor.byteOffset);
+        layout.strides[a] = (GLuint) getAccessorStride(model, accessor);
+        layout.types[a] = (GLuint) accessor.componentType | (accessor.isNormalized ? 1u << 16 : 0u);
+    }
+
+    const Accessor &indexAccessor = model.accessors[meshPrimitive->indices];
+    const char* indices = getAccessorData(model, indexAccessor);
+    PulledMesh mesh = { (GLuint) pulling.indexData.size(), (GLuint) indexAccessor.count, meshPrimitive->material };
+
+    for (int a = 0; a < indexAccessor.count; ++a) {
+        pulling.indexData.push_back(getIndex(indices, indexAccessor.componentType, a));
+    }
+
+    pulling.layouts.push_back(layout);
+    pulling.meshes.push_back(mesh);
+
+    // Models are added at load time, so the pools are simply uploaded again in full
+    pulling.vertexData.resize((pulling.vertexData.size() + 3) & ~(size_t) 3);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, getResource(resources, pulling.vertexBuffer));
+    glBufferData(GL_SHADER_STORAGE_BUFFER, pulling.vertexData.size(), pulling.vertexData.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, getResource(resources, pulling.layoutBuffer));
+    glBufferData(GL_SHADER_STORAGE_BUFFER, pulling.layouts.size() * sizeof(PulledLayout), pulling.layouts.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glBindVertexArray(getResource(resources, pulling.vao));
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, pulling.indexData.size() * sizeof(GLuint), pulling.indexData.data(), GL_STATIC_DRAW);
+    glBindVertexArray(0);
+    setResourceSize(resources, pulling.vertexBuffer, pulling.vertexData.size());
+    setResourceSize(resources, pulling.layoutBuffer, pulling.layouts.size() * sizeof(PulledLayout));
+    setResourceSize(resources, pulling.indexBuffer, pulling.indexData.size() * sizeof(GLuint));
+
+    return (int) pulling.meshes.size() - 1;
+}
+
+int drawPulledModels(Renderer &renderer, const Frame &frame) {
+    VertexPulling &pulling = renderer.pulling;
+    Resources &resources = renderer.resources;
+    GlState &state = renderer.state;
+    pulling.draws.clear();
+
+    for (auto index : frame.drawList) {
+        const Instance &instance = frame.instances[index];
+        const Model &model = renderer.models[instance.model];
+
+        if (model.pulledMesh == -1) {
+            continue;
+        }
+
+        TextureHandle handle = getMaterialHandle(model, pulling.meshes[model.pulledMesh].material);
+        pulling.draws.push_back({ getPageTexture(renderer, handle), glm::uvec4(model.pulledMesh, instance.transform, handle.layer, 0) });
+    }
+
+    if (pulling.draws.empty()) {
+        return 0;
+    }
+
+    // Draws sharing a texture page become one multi-draw, the base instance selects each draw's data
+    std::stable_sort(pulling.draws.begin(), pulling.draws.end(), [](const PulledDraw &a, const PulledDraw &b) {
+        return a.texture < b.texture;
+    });
+
+    pulling.drawData.clear();
+    pulling.commands.clear();
+
+    for (auto &draw : pulling.draws) {
+        const PulledMesh &mesh = pulling.meshes[draw.data.x];
+        pulling.commands.push_back({ mesh.indexCount, 1, mesh.firstIndex, 0, (GLuint) pulling.drawData.size() });
+        pulling.drawData.push_back(draw.data);
+    }
+
+    bindBuffer(state, GL_ARRAY_BUFFER, getResource(resources, pulling.drawBuffer));
+    glBufferData(GL_ARRAY_BUFFER, pulling.drawData.size() * sizeof(glm::uvec4), pulling.drawData.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, getResource(resources, pulling.indirectBuffer));
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, pulling.commands.size() * sizeof(DrawElementsIndirectCommand), pulling.commands.data(), GL_STREAM_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PULLED_VERTEX_BINDING, getResource(resources, pulling.vertexBuffer));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PULLED_LAYOUT_BINDING, getResource(resources, pulling.layoutBuffer));
+    setResourceSize(resources, pulling.drawBuffer, pulling.drawData.size() * sizeof(glm::uvec4));
+    setResourceSize(resources, pulling.indirectBuffer, pulling.commands.size() * sizeof(DrawElementsIndirectCommand));
+    useProgram(state, pulling.program);
+    bindVertexArray(state, getResource(resources, pulling.vao));
+
+    int multiDrawCount = 0;
+
+    for (size_t first = 0; first < pulling.draws.size();) {
+        size_t last = first;
+
+        while (last < pulling.draws.size() && pulling.draws[last].texture == pulling.draws[first].texture) {
+            last++;
+        }
+
+        bindTexture(state, 0, GL_TEXTURE_2D_ARRAY, pulling.draws[first].texture);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (const void*) (first * sizeof(DrawElementsIndirectCommand)), (GLsizei) (last - first), 0);
+        multiDrawCount++;
+        first = last;
+    }
+
+    return multiDrawCount;
+}
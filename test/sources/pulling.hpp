@@ -0,0 +1,67 @@
+#pragma once
+#include "state.hpp"
+#include "resources.hpp"
+#include <vector>
+#include <glad/glad.h>
+#include <glm/vec4.hpp>
+
+const GLuint PULLED_VERTEX_BINDING = 0;
+const GLuint PULLED_LAYOUT_BINDING = 1;
+const GLuint PULLED_DRAW_LOCATION = 3;
+
+struct Model;
+struct Renderer;
+struct Frame;
+
+// Offsets, strides and component types of position, normal and uv, read by include/pulling.glsl
+struct PulledLayout {
+    glm::uvec4 offsets = glm::uvec4(0);
+    glm::uvec4 strides = glm::uvec4(0);
+    glm::uvec4 types = glm::uvec4(0);
+};
+
+struct PulledMesh {
+    GLuint firstIndex = 0;
+    GLuint indexCount = 0;
+    int material = -1;
+};
+
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+struct PulledDraw {
+    GLuint texture;
+    glm::uvec4 data;
+};
+
+struct VertexPulling {
+    bool isSupported = false;
+    bool isReady = false;
+    GLuint program = 0;
+    std::vector<unsigned char> vertexData;
+    std::vector<GLuint> indexData;
+    std::vector<PulledLayout> layouts;
+    std::vector<PulledMesh> meshes;
+    ResourceHandle vertexBuffer;
+    ResourceHandle layoutBuffer;
+    ResourceHandle indexBuffer;
+    ResourceHandle drawBuffer;
+    ResourceHandle indirectBuffer;
+    ResourceHandle vao;
+    std::vector<PulledDraw> draws;
+    std::vector<glm::uvec4> drawData;
+    std::vector<DrawElementsIndirectCommand> commands;
+};
+
+void createVertexPulling(VertexPulling &pulling, Resources &resources);
+
+void destroyVertexPulling(VertexPulling &pulling, Resources &resources);
+
+int addPulledModel(VertexPulling &pulling, Resources &resources, const Model &model);
+
+int drawPulledModels(Renderer &renderer, const Frame &frame);
@@ -62,6 +62,10 @@ GLuint createShaderProgram(const std::map<std::string, std::string> &typeSourceM
         glAttachShader(program, shader);
     }
 
+    if (GLAD_GL_ARB_get_program_binary) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
     glLinkProgram(program);
 
     for (auto shader : shaders) {
@@ -88,43 +92,32 @@ GLuint createShaderProgram(const std::map<std::string, std::string> &typeSourceM
     return program;
 }
 
-GLuint loadShaderProgram(const std::string &path) {
-    std::ifstream shaderProgramFile(path);
+GLuint loadShaderProgram(const std::string &path, const ShaderDefines &defines) {
+    PreprocessedShader shader;
 
-    if (!shaderProgramFile.is_open()) {
-        std::cout << "Failed to open shader program file" << std::endl;
+    if (preprocessShader(shader, shaderCache.files, path, defines) == -1) {
+        std::cout << "Failed to preprocess shader program file" << std::endl;
 
         return GL_FALSE;
     }
 
-    std::string line;
-    std::string type;
-    std::string source;
-    std::map<std::string, std::string> typeSourceMap;
+    GLuint program = createCachedProgram(shaderCache, shader.stages, joinShaderDefines(defines));
 
-    while (std::getline(shaderProgramFile, line)) {
-        std::cmatch matches;
-
-        if (std::regex_match(line.c_str(), matches, std::regex("#type ([a-z]{6,8})"))) {
-            if (type.empty()) {
-                type = matches[1];
-            } else {
-                if (type != matches[1]) {
-                    typeSourceMap.insert({ type, source });
-                    type = matches[1];
-                    source = "";
-                }
-            }
-        } else {
-            if (!type.empty()) {
-                source += line + "\n";
-            }
+    // Compiler errors are reported as "<source>:<line>", so list which file each source number is
+    if (program == GL_FALSE) {
+        for (int a = 0; a < (int) shader.files.size(); ++a) {
+            std::cout << a << ": " << shader.files[a] << std::endl;
         }
     }
 
-    typeSourceMap.insert({ type, source });
+    return program;
+}
 
-    return createShaderProgram(typeSourceMap);
+void bindUniformBlocks(GLuint program) {
+    bindUniformBlock(program, "Camera", CAMERA_UNIFORM_BINDING);
+    bindUniformBlock(program, "Object", OBJECT_UNIFORM_BINDING);
+    bindUniformBlock(program, "Grid", OBJECT_UNIFORM_BINDING);
+    bindUniformBlock(program, "Impostor", OBJECT_UNIFORM_BINDING);
 }
 
 void updateCamera(Camera &camera) {
@@ -173,58 +166,25 @@ glm::mat4 getCameraView(const Camera &camera) {
     return glm::lookAt(camera.position, camera.position + camera.forward, camera.up);
 }
 
-Grid createGrid() {
-    float positions[] = {
-        -1.0f, 0.0f, -1.0f,
-        -1.0f, 0.0f, 1.0f,
-        1.0f, 0.0f, -1.0f,
-        -1.0f, 0.0f, 1.0f,
-        1.0f, 0.0f, 1.0f,
-        1.0f, 0.0f, -1.0f
-    };
-
-    float uvs[] = {
-        0.0f, 0.0f,
-        0.0f, 1.0f,
-        1.0f, 0.0f,
-        0.0f, 1.0f,
-        1.0f, 1.0f,
-        1.0f, 0.0f
-    };
-
+Grid createGrid(Resources &resources) {
     Grid grid;
-    grid.shaderProgram = loadShaderProgram("../assets/shaders/grid.glsl");
-
-    glGenVertexArrays(1, &grid.vao);
-    glBindVertexArray(grid.vao);
-
-    grid.positionBuffer;
-    glGenBuffers(1, &grid.positionBuffer);
-    glBindBuffer(GL_ARRAY_BUFFER, grid.positionBuffer);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(positions), positions, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), nullptr);
-
-    grid.uvBuffer;
-    glGenBuffers(1, &grid.uvBuffer);
-    glBindBuffer(GL_ARRAY_BUFFER, grid.uvBuffer);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(uvs), uvs, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
+    grid.shaderProgram = adoptResource(resources, ResourceType::Program, loadShaderProgram("../assets/shaders/grid.glsl"));
+    bindUniformBlocks(getResource(resources, grid.shaderProgram));
 
-    glEnableVertexAttribArray(0);
+    // The full-screen pass generates its vertices, core profile still needs a vertex array bound
+    grid.vao = createResource(resources, ResourceType::VertexArray);
 
     return grid;
 }
 
-void renderGrid(const Renderer &renderer) {
-    glUseProgram(renderer.grid.shaderProgram);
-    glBindVertexArray(renderer.grid.vao);
-    glUniformMatrix4fv(0, 1, GL_FALSE, glm::value_ptr(getCameraProjection(renderer.camera, renderer.viewport)));
-    glUniformMatrix4fv(1, 1, GL_FALSE, glm::value_ptr(getCameraView(renderer.camera)));
-    glUniform3fv(2, 1, glm::value_ptr(renderer.camera.position));
-    glUniform3fv(3, 1, glm::value_ptr(renderer.grid.color));
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+void renderGrid(Renderer &renderer) {
+    GlState &state = renderer.state;
+    useProgram(state, getResource(renderer.resources, renderer.grid.shaderProgram));
+    bindVertexArray(state, getResource(renderer.resources, renderer.grid.vao));
+    setCapability(state, GL_BLEND, true);
+    setBlendFunc(state, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    bindBufferRange(state, GL_UNIFORM_BUFFER, OBJECT_UNIFORM_BINDING, getResource(renderer.resources, renderer.uniforms.buffer), renderer.gridUniformOffset, sizeof(GridUniforms));
+    glDrawArrays(GL_TRIANGLES, 0, 3);
 }
 
 int getComponentCount(const std::string &type) {
@@ -243,6 +203,63 @@ int getComponentCount(const std::string &type) {
     return 0;
 }
 
+const char* getAccessorData(const Model &model, const Accessor &accessor) {
+    const BufferView &bufferView = model.bufferViews[accessor.bufferView];
+
+    return model.buffer.data() + bufferView.byteOffset + accessor.byteOffset;
+}
+
+int getComponentSize(int componentType) {
+    if (componentType == GL_BYTE || componentType == GL_UNSIGNED_BYTE) {
+        return 1;
+    }
+
+    if (componentType == GL_SHORT || componentType == GL_UNSIGNED_SHORT) {
+        return 2;
+    }
+
+    return 4;
+}
+
+int getAccessorStride(const Model &model, const Accessor &accessor) {
+    const BufferView &bufferView = model.bufferViews[accessor.bufferView];
+
+    // Tightly packed unless the view interleaves several attributes
+    return bufferView.byteStride ? bufferView.byteStride : getComponentCount(accessor.type) * getComponentSize(accessor.componentType);
+}
+
+int findAttribute(const MeshPrimitive &meshPrimitive, const std::string &key) {
+    for (auto &primitiveAttribute : meshPrimitive.attributes) {
+        if (primitiveAttribute.key == key) {
+            return primitiveAttribute.value;
+        }
+    }
+
+    return -1;
+}
+
+bool isOccluderMesh(const Mesh &mesh) {
+    const std::string suffix = "_occluder";
+
+    return mesh.name.size() >= suffix.size() && mesh.name.compare(mesh.name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+int getAttributeLocation(const std::string &key) {
+    if (key == "POSITION") {
+        return 0;
+    }
+
+    if (key == "NORMAL") {
+        return 1;
+    }
+
+    if (key == "TEXCOORD_0") {
+        return 2;
+    }
+
+    return -1;
+}
+
 int loadModel(Model &model, const std::string &path) {
     std::ifstream modelFile(path, std::ios::binary);
 
@@ -264,7 +281,7 @@ int loadModel(Model &model, const std::string &path) {
     modelFile.read((char*) &bufferLength, sizeof(bufferLength));
     modelFile.seekg(sizeof(uint32_t), std::ios_base::cur);
 
-    model.buffer.reserve(bufferLength);
+    model.buffer.resize(bufferLength);
     modelFile.read(model.buffer.data(), bufferLength);
 
     try {
@@ -388,6 +405,14 @@ int loadModel(Model &model, const std::string &path) {
                 error = accessorElement["type"].get_string().get(type);
                 accessor.type = std::string(type.data(), type.size());
 
+                int64_t byteOffset = 0;
+                error = accessorElement["byteOffset"].get_int64().get(byteOffset);
+                accessor.byteOffset = (int) byteOffset;
+
+                bool isNormalized = false;
+                error = accessorElement["normalized"].get_bool().get(isNormalized);
+                accessor.isNormalized = isNormalized;
+
                 model.accessors.push_back(accessor);
             }
         }
@@ -403,85 +428,689 @@ int loadModel(Model &model, const std::string &path) {
                 
                 bufferView.buffer = (int) bufferViewElement["buffer"].get_int64();
                 bufferView.byteLength = (int) bufferViewElement["byteLength"].get_int64();
-                error = bufferViewElement["byteOffset"].get_int64().get((int64_t&) bufferView.byteOffset);
+
+                int64_t byteOffset = 0;
+                error = bufferViewElement["byteOffset"].get_int64().get(byteOffset);
+                bufferView.byteOffset = (int) byteOffset;
+
+                int64_t byteStride = 0;
+                error = bufferViewElement["byteStride"].get_int64().get(byteStride);
+                bufferView.byteStride = (int) byteStride;
 
                 model.bufferViews.push_back(bufferView);
             }
         }
+
+        simdjson::ondemand::array images;
+        error = document["images"].get_array().get(images);
+
+        if (!error) {
+            for (auto imageElement : images) {
+                Image image;
+
+                int64_t bufferView = -1;
+                error = imageElement["bufferView"].get_int64().get(bufferView);
+                image.bufferView = (int) bufferView;
+
+                std::string_view mimeType;
+                error = imageElement["mimeType"].get_string().get(mimeType);
+                image.mimeType = std::string(mimeType.data(), mimeType.size());
+
+                model.images.push_back(image);
+            }
+        }
+
+        simdjson::ondemand::array textures;
+        error = document["textures"].get_array().get(textures);
+
+        if (!error) {
+            for (auto textureElement : textures) {
+                Texture texture;
+
+                int64_t source = -1;
+                error = textureElement["source"].get_int64().get(source);
+                texture.source = (int) source;
+
+                model.textures.push_back(texture);
+            }
+        }
+
+        simdjson::ondemand::array materials;
+        error = document["materials"].get_array().get(materials);
+
+        if (!error) {
+            for (auto materialElement : materials) {
+                Material material;
+
+                std::string_view name;
+                error = materialElement["name"].get_string().get(name);
+                material.name = std::string(name.data(), name.size());
+
+                int64_t baseColorTexture = -1;
+                error = materialElement["pbrMetallicRoughness"]["baseColorTexture"]["index"].get_int64().get(baseColorTexture);
+                material.baseColorTexture = (int) baseColorTexture;
+
+                model.materials.push_back(material);
+            }
+        }
     } catch (simdjson::simdjson_error &e) {
         std::cout << e.error() << std::endl;
 
         return -1;
     }
 
+    computeBounds(model);
+
     return 0;
 }
 
-void bindModel(Model &model) {
+void computeBounds(Model &model) {
+    bool isEmpty = true;
+
+    for (auto &mesh : model.meshes) {
+        if (isOccluderMesh(mesh)) {
+            continue;
+        }
+
+        for (auto &meshPrimitive : mesh.primitives) {
+            int positionAccessorIndex = findAttribute(meshPrimitive, "POSITION");
+
+            if (positionAccessorIndex == -1) {
+                continue;
+            }
+
+            const Accessor &accessor = model.accessors[positionAccessorIndex];
+            const char* positions = getAccessorData(model, accessor);
+            int stride = getAccessorStride(model, accessor);
+
+            for (int a = 0; a < accessor.count; ++a) {
+                const float* components = (const float*) (positions + a * stride);
+                glm::vec3 position = glm::vec3(components[0], components[1], components[2]);
+                model.boundsMin = isEmpty ? position : glm::min(model.boundsMin, position);
+                model.boundsMax = isEmpty ? position : glm::max(model.boundsMax, position);
+                isEmpty = false;
+            }
+        }
+    }
+}
+
+uint32_t getIndex(const char* data, int componentType, int index) {
+    if (componentType == GL_UNSIGNED_BYTE) {
+        return ((const uint8_t*) data)[index];
+    }
+
+    if (componentType == GL_UNSIGNED_SHORT) {
+        return ((const uint16_t*) data)[index];
+    }
+
+    return ((const uint32_t*) data)[index];
+}
+
+void createOccluder(Model &model, int maxTriangleCount) {
+    model.occluder = OccluderMesh();
+    const MeshPrimitive* occluderPrimitive = nullptr;
+
+    // Dedicated "_occluder" meshes (hulls, low LODs) win, otherwise the render mesh is used if it is cheap enough
+    for (auto &mesh : model.meshes) {
+        if (isOccluderMesh(mesh) && !mesh.primitives.empty()) {
+            occluderPrimitive = &mesh.primitives[0];
+
+            break;
+        }
+    }
+
+    if (!occluderPrimitive) {
+        for (auto &mesh : model.meshes) {
+            if (!mesh.primitives.empty() && model.accessors[mesh.primitives[0].indices].count / 3 <= maxTriangleCount) {
+                occluderPrimitive = &mesh.primitives[0];
+
+                break;
+            }
+        }
+    }
+
+    if (!occluderPrimitive) {
+        return;
+    }
+
+    int positionAccessorIndex = findAttribute(*occluderPrimitive, "POSITION");
+
+    if (positionAccessorIndex == -1) {
+        return;
+    }
+
+    const Accessor &positionAccessor = model.accessors[positionAccessorIndex];
+    const char* positions = getAccessorData(model, positionAccessor);
+    int stride = getAccessorStride(model, positionAccessor);
+    model.occluder.positions.reserve(positionAccessor.count);
+
+    for (int a = 0; a < positionAccessor.count; ++a) {
+        const float* components = (const float*) (positions + a * stride);
+        model.occluder.positions.push_back(glm::vec3(components[0], components[1], components[2]));
+    }
+
+    const Accessor &indexAccessor = model.accessors[occluderPrimitive->indices];
+    const char* indices = getAccessorData(model, indexAccessor);
+    model.occluder.indices.reserve(indexAccessor.count);
+
+    for (int a = 0; a < indexAccessor.count; ++a) {
+        model.occluder.indices.push_back(getIndex(indices, indexAccessor.componentType, a));
+    }
+}
+
+void bindModel(Renderer &renderer, Model &model) {
+    Resources &resources = renderer.resources;
+    Uploads &uploads = renderer.uploads;
     Scene &scene = model.scenes[model.scene];
 
     for (auto nodeIndex : scene.nodes) {
         Node &node = model.nodes[nodeIndex];
 
-        if (node.mesh > -1) {
+        if (node.mesh > -1 && !isOccluderMesh(model.meshes[node.mesh])) {
             Mesh &mesh = model.meshes[node.mesh];
             MeshPrimitive &meshPrimitive = mesh.primitives[0];
-            glGenVertexArrays(1, &model.vao);
-            glBindVertexArray(model.vao);
+            model.drawCount++;
+
+            // Every node binds into the same model-wide arrays, the previous node's are released rather than dropped
+            releaseResource(resources, model.vao);
+            releaseResource(resources, model.depthVao);
+            releaseResource(resources, model.indexBuffer);
+            model.vao = createResource(resources, ResourceType::VertexArray);
+            glBindVertexArray(getResource(resources, model.vao));
+
+            // Interleaved attributes share a view, which is uploaded once
+            std::map<int, GLuint> viewBuffers;
+            GLuint positionBuffer = 0;
+            int positionAccessor = -1;
 
             for (auto &primitiveAttribute : meshPrimitive.attributes) {
                 Accessor &accessor = model.accessors[primitiveAttribute.value];
                 BufferView &bufferView = model.bufferViews[accessor.bufferView];
 
                 int componentCount = getComponentCount(accessor.type);
+                int location = getAttributeLocation(primitiveAttribute.key);
+
+                if (location == -1) {
+                    continue;
+                }
+
+                GLuint &buffer = viewBuffers[accessor.bufferView];
+
+                if (!buffer) {
+                    model.buffers.push_back(createResource(resources, ResourceType::Buffer));
+                    buffer = getResource(resources, model.buffers.back());
+                    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+                    glBufferData(GL_ARRAY_BUFFER, bufferView.byteLength, nullptr, GL_STATIC_DRAW);
+                    setResourceSize(resources, model.buffers.back(), bufferView.byteLength);
+                    model.uploadTicket = queueBufferUpload(uploads, model.buffers.back(), 0, &model.buffer[0] + bufferView.byteOffset, bufferView.byteLength);
+                }
 
-                GLuint buffer;
-                glGenBuffers(1, &buffer);
                 glBindBuffer(GL_ARRAY_BUFFER, buffer);
-                glBufferData(GL_ARRAY_BUFFER, bufferView.byteLength, &model.buffer[0] + bufferView.byteOffset, GL_STATIC_DRAW);
-                glEnableVertexAttribArray(primitiveAttribute.value);
-                glVertexAttribPointer(primitiveAttribute.value, componentCount, accessor.componentType, GL_FALSE, componentCount * sizeof(float), nullptr);
+                glEnableVertexAttribArray(location);
+                glVertexAttribPointer(location, componentCount, accessor.componentType, accessor.isNormalized, getAccessorStride(model, accessor), (void*) (intptr_t) accessor.byteOffset);
+
+                if (location == 0) {
+                    positionBuffer = buffer;
+                    positionAccessor = primitiveAttribute.value;
+                }
             }
 
             Accessor &indexAccessor = model.accessors[meshPrimitive.indices];
             BufferView &indexBufferView = model.bufferViews[indexAccessor.bufferView];
 
-            GLuint buffer;
-            glGenBuffers(1, &buffer);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBufferView.byteLength, &model.buffer[0] + indexBufferView.byteOffset, GL_STATIC_DRAW);
+            model.indexBuffer = createResource(resources, ResourceType::Buffer);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, getResource(resources, model.indexBuffer));
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBufferView.byteLength, nullptr, GL_STATIC_DRAW);
+            setResourceSize(resources, model.indexBuffer, indexBufferView.byteLength);
+            model.uploadTicket = queueBufferUpload(uploads, model.indexBuffer, 0, &model.buffer[0] + indexBufferView.byteOffset, indexBufferView.byteLength);
+
+            // Position-only stream for the depth pre-pass, sharing the same buffers
+            model.depthVao = createResource(resources, ResourceType::VertexArray);
+            glBindVertexArray(getResource(resources, model.depthVao));
+            glBindBuffer(GL_ARRAY_BUFFER, positionBuffer);
             glEnableVertexAttribArray(0);
+
+            if (positionAccessor != -1) {
+                const Accessor &accessor = model.accessors[positionAccessor];
+                glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, getAccessorStride(model, accessor), (void*) (intptr_t) accessor.byteOffset);
+            }
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, getResource(resources, model.indexBuffer));
         }
     }
 }
 
-void drawModels(Renderer &renderer) {
-    for (auto model : renderer.models) {
-        Scene &scene = model.scenes[model.scene];
+void destroyModel(Model &model, Resources &resources) {
+    for (auto &buffer : model.buffers) {
+        releaseResource(resources, buffer);
+    }
+
+    model.buffers.clear();
+    releaseResource(resources, model.indexBuffer);
+    releaseResource(resources, model.vao);
+    releaseResource(resources, model.depthVao);
+}
+
+void cullInstances(Renderer &renderer, Frame &frame, const glm::mat4 &viewProjection) {
+    Occlusion &occlusion = renderer.occlusion;
+    clearOcclusion(occlusion);
+    frame.drawList.clear();
+
+    if (occlusion.isEnabled) {
+        for (auto &instance : frame.instances) {
+            const Model &model = renderer.models[instance.model];
+
+            if (!model.occluder.indices.empty()) {
+                addOccluder(occlusion, viewProjection * instance.matrix, model.occluder);
+            }
+        }
+
+        rasterizeOcclusion(occlusion, renderer.jobs);
+    }
+
+    for (int a = 0; a < (int) frame.instances.size(); ++a) {
+        const Instance &instance = frame.instances[a];
+        const Model &model = renderer.models[instance.model];
+
+        if (!isOccluded(occlusion, viewProjection * instance.matrix, model.boundsMin, model.boundsMax)) {
+            frame.drawList.push_back(a);
+        }
+    }
+}
+
+void loadModelTextures(Renderer &renderer, Model &model) {
+    model.textureHandles.assign(model.textures.size(), TextureHandle());
+
+    for (int a = 0; a < (int) model.textures.size(); ++a) {
+        int source = model.textures[a].source;
+
+        if (source < 0 || source >= (int) model.images.size() || model.images[source].bufferView < 0) {
+            continue;
+        }
+
+        const BufferView &bufferView = model.bufferViews[model.images[source].bufferView];
+        model.textureHandles[a] = loadStreamedTexture(renderer.streaming, renderer.resources, renderer.uploads, (const unsigned char*) model.buffer.data() + bufferView.byteOffset, bufferView.byteLength);
+        model.uploadTicket = renderer.uploads.queuedTicket;
+    }
+}
+
+TextureHandle getMaterialHandle(const Model &model, int material) {
+    if (material < 0 || material >= (int) model.materials.size()) {
+        return TextureHandle();
+    }
+
+    int texture = model.materials[material].baseColorTexture;
+
+    if (texture < 0 || texture >= (int) model.textureHandles.size()) {
+        return TextureHandle();
+    }
+
+    return model.textureHandles[texture];
+}
+
+GLuint getPageTexture(const Renderer &renderer, const TextureHandle &handle) {
+    return getResource(renderer.resources, handle.page == -1 ? renderer.defaultTexture : renderer.streaming.pages[handle.page].texture);
+}
+
+void requestTextureLevels(Renderer &renderer, Frame &frame) {
+    frame.textureRequests.assign(renderer.streaming.pages.size(), INT32_MAX);
+    float pixelsPerUnit = frame.viewport.y / (2.0f * tanf(glm::radians(frame.camera.zoom) * 0.5f));
+
+    // Projected size of each visible model picks the finest level any of its materials needs
+    for (auto instanceIndex : frame.drawList) {
+        const Instance &instance = frame.instances[instanceIndex];
+        const Model &model = renderer.models[instance.model];
+
+        if (model.textureHandles.empty()) {
+            continue;
+        }
+
+        glm::vec4 center = instance.matrix * glm::vec4((model.boundsMin + model.boundsMax) * 0.5f, 1.0f);
+        glm::vec3 axes = glm::vec3(glm::length(glm::vec3(instance.matrix[0])), glm::length(glm::vec3(instance.matrix[1])), glm::length(glm::vec3(instance.matrix[2])));
+        float radius = glm::length((model.boundsMax - model.boundsMin) * axes) * 0.5f;
+        float distance = glm::length(glm::vec3(center.x, center.y, center.z) - frame.camera.position);
+        float screenSize = distance > radius ? 2.0f * radius / distance * pixelsPerUnit : (float) frame.viewport.y * 4.0f;
+
+        for (auto &mesh : model.meshes) {
+            for (auto &meshPrimitive : mesh.primitives) {
+                TextureHandle handle = getMaterialHandle(model, meshPrimitive.material);
+
+                if (handle.page == -1) {
+                    continue;
+                }
+
+                int level = getTextureLevel(renderer.streaming.pages[handle.page], screenSize);
+                frame.textureRequests[handle.page] = std::min(frame.textureRequests[handle.page], level);
+            }
+        }
+    }
+}
+
+void sortFrontToBack(Renderer &renderer, Frame &frame) {
+    std::vector<std::pair<float, int>> keys;
+    keys.reserve(frame.drawList.size());
+
+    for (auto instanceIndex : frame.drawList) {
+        const Instance &instance = frame.instances[instanceIndex];
+        const Model &model = renderer.models[instance.model];
+        glm::vec4 center = instance.matrix * glm::vec4((model.boundsMin + model.boundsMax) * 0.5f, 1.0f);
+        glm::vec3 delta = glm::vec3(center.x, center.y, center.z) - frame.camera.position;
+        keys.push_back({ glm::dot(delta, delta), instanceIndex });
+    }
+
+    std::sort(keys.begin(), keys.end());
+
+    for (size_t a = 0; a < keys.size(); ++a) {
+        frame.drawList[a] = keys[a].second;
+    }
+}
+
+void buildFrame(Renderer &renderer, Frame &frame) {
+    frame.camera = renderer.camera;
+    frame.viewport = renderer.viewport;
+    frame.windowSize = renderer.windowSize;
+    frame.isViewportPanel = renderer.isViewportPanel;
+    frame.clearColor = renderer.clearColor;
+    frame.gridColor = renderer.grid.color;
+    frame.gridSpacing = renderer.grid.spacing;
+    frame.gridFadeRadius = renderer.grid.fadeRadius;
+    frame.instances = renderer.instances;
+    frame.instances.insert(frame.instances.end(), renderer.entityInstances.begin(), renderer.entityInstances.end());
+
+    // Each frame is rendered exactly once, so pending matrix updates can move into it
+    frame.transformUpdates.swap(renderer.transformSlots.updates);
+    renderer.transformSlots.updates.clear();
+    frame.transformCount = renderer.transformSlots.count;
+    frame.isVertexPulling = renderer.isVertexPulling && renderer.pulling.isSupported;
+    frame.isPulledDraw = frame.isVertexPulling && renderer.stats.isPulledReady;
+
+    // Pulled draws have no depth-only stream, so the pre-pass would leave them failing GL_EQUAL
+    frame.isDepthPrepass = renderer.isDepthPrepass && !frame.isPulledDraw;
+    frame.shaderFeatures = renderer.shaderFeatures;
+    frame.swapInterval = renderer.swapInterval;
+
+    // Textures get whatever the overall budget leaves after everything else, as of the last rendered frame
+    GLsizeiptr otherSize = -renderer.stats.textureSize;
+
+    for (auto size : renderer.stats.resourceSizes) {
+        otherSize += size;
+    }
+
+    frame.textureBudget = std::min(renderer.streaming.budget, std::max(renderer.memoryBudget - otherSize, (GLsizeiptr) 0));
+    frame.uploadBudget = renderer.uploads.budget;
+    frame.memoryBudget = renderer.memoryBudget;
+
+    if (renderer.resolution.isEnabled) {
+        updateResolutionScale(renderer.resolution, getGpuMilliseconds(renderer.stats.timings));
+        frame.resolutionScale = renderer.resolution.scale;
+    } else {
+        frame.resolutionScale = 1.0f;
+    }
 
-        for (auto nodeIndex : scene.nodes) {
-            Node &node = model.nodes[nodeIndex];
+    glm::mat4 projection = getCameraProjection(frame.camera, frame.viewport);
+    glm::mat4 view = getCameraView(frame.camera);
+    cullInstances(renderer, frame, projection * view);
+    selectImpostors(renderer, frame);
+    assignLights(renderer.lighting, renderer.jobs, frame.lightClusters, projection, view, frame.camera.near, frame.camera.far);
+    requestTextureLevels(renderer, frame);
 
-            if (node.mesh > -1) {
-                Mesh &mesh = model.meshes[node.mesh];
-                MeshPrimitive &meshPrimitive = mesh.primitives[0];
-                Accessor &indexAccessor = model.accessors[meshPrimitive.indices];
-                glBindVertexArray(model.vao);
-                glDrawElements(GL_TRIANGLES, indexAccessor.count, GL_UNSIGNED_SHORT, nullptr);
+    // Front-to-back order lets early-Z reject hidden fragments in the pre-pass
+    if (frame.isDepthPrepass) {
+        sortFrontToBack(renderer, frame);
+    }
+}
+
+void recordModels(Renderer &renderer, const Frame &frame, const UniformAllocation &objectUniforms) {
+    int drawCount = (int) frame.drawList.size();
+    int sliceCount = std::clamp((drawCount + renderer.minCommandSlice - 1) / renderer.minCommandSlice, 1, getJobConcurrency(renderer.jobs));
+    int sliceSize = (drawCount + sliceCount - 1) / sliceCount;
+    GLsizeiptr objectStride = alignUniformSize(renderer.uniforms, sizeof(ObjectUniforms));
+    GLuint uniformBuffer = getResource(renderer.resources, renderer.uniforms.buffer);
+    const std::vector<int> &drawOffsets = renderer.drawOffsets;
+    renderer.commandBuffers.resize(sliceCount);
+    renderer.depthCommandBuffers.resize(sliceCount);
+
+    // Every slice writes its own part of the object uniforms and its own command buffer, GL is only touched on submit
+    parallelFor(renderer.jobs, sliceCount, [&renderer, &frame, &objectUniforms, &drawOffsets, drawCount, sliceSize, objectStride, uniformBuffer](int begin, int end) {
+        for (int slice = begin; slice < end; ++slice) {
+            CommandBuffer &commandBuffer = renderer.commandBuffers[slice];
+            CommandBuffer &depthCommandBuffer = renderer.depthCommandBuffers[slice];
+            clearCommands(commandBuffer);
+            clearCommands(depthCommandBuffer);
+
+            if (!objectUniforms.data) {
+                continue;
+            }
+
+            for (int a = slice * sliceSize; a < std::min((slice + 1) * sliceSize, drawCount); ++a) {
+                const Instance &instance = frame.instances[frame.drawList[a]];
+                const Model &model = renderer.models[instance.model];
+                const Scene &scene = model.scenes[model.scene];
+                int draw = drawOffsets[a];
+
+                if (frame.isPulledDraw && model.pulledMesh != -1) {
+                    continue;
+                }
+
+                for (auto nodeIndex : scene.nodes) {
+                    const Node &node = model.nodes[nodeIndex];
+
+                    if (node.mesh > -1 && !isOccluderMesh(model.meshes[node.mesh])) {
+                        const MeshPrimitive &meshPrimitive = model.meshes[node.mesh].primitives[0];
+                        const Accessor &indexAccessor = model.accessors[meshPrimitive.indices];
+                        TextureHandle handle = getMaterialHandle(model, meshPrimitive.material);
+                        GLintptr offset = objectUniforms.offset + draw * objectStride;
+
+                        // The layer rides along with the object data, so draws sharing a page keep the same texture binding
+                        ObjectUniforms uniforms = { glm::vec4((float) handle.layer, (float) instance.transform, 0.0f, 0.0f) };
+                        memcpy(objectUniforms.data + draw * objectStride, &uniforms, sizeof(ObjectUniforms));
+                        draw++;
+
+                        recordBindUniforms(commandBuffer, OBJECT_UNIFORM_BINDING, uniformBuffer, offset, sizeof(ObjectUniforms));
+                        recordBindTexture(commandBuffer, 0, GL_TEXTURE_2D_ARRAY, getPageTexture(renderer, handle));
+                        recordBindVertexArray(commandBuffer, getResource(renderer.resources, model.vao));
+                        recordDrawElements(commandBuffer, indexAccessor.count, indexAccessor.componentType, indexAccessor.byteOffset);
+
+                        if (frame.isDepthPrepass) {
+                            recordBindUniforms(depthCommandBuffer, OBJECT_UNIFORM_BINDING, uniformBuffer, offset, sizeof(ObjectUniforms));
+                            recordBindVertexArray(depthCommandBuffer, getResource(renderer.resources, model.depthVao));
+                            recordDrawElements(depthCommandBuffer, indexAccessor.count, indexAccessor.componentType, indexAccessor.byteOffset);
+                        }
+                    }
+                }
             }
         }
+    });
+}
+
+void prepareFrame(Renderer &renderer, const Frame &frame, const glm::mat4 &projection, const glm::mat4 &view) {
+    UniformRing &uniforms = renderer.uniforms;
+
+    // Every drawn node gets its own object slot, offsets are prefix sums over the draw list
+    renderer.drawOffsets.resize(frame.drawList.size() + 1);
+    renderer.drawOffsets[0] = 0;
+
+    for (int a = 0; a < (int) frame.drawList.size(); ++a) {
+        renderer.drawOffsets[a + 1] = renderer.drawOffsets[a] + renderer.models[frame.instances[frame.drawList[a]].model].drawCount;
     }
+
+    // The ring grows before anything is written, so a busy frame never runs out halfway
+    GLsizeiptr objectSize = alignUniformSize(uniforms, sizeof(ObjectUniforms)) * renderer.drawOffsets.back();
+    GLsizeiptr impostorSize = alignUniformSize(uniforms, sizeof(ImpostorUniforms)) * (GLsizeiptr) frame.impostorBatches.size();
+    beginUniformFrame(uniforms, renderer.resources, alignUniformSize(uniforms, sizeof(CameraUniforms)) + alignUniformSize(uniforms, sizeof(GridUniforms)) + objectSize + impostorSize);
+
+    // Camera data is shared by every draw in the frame, per-object data gets its own aligned slice
+    CameraUniforms cameraUniforms = { projection, view, glm::vec4(frame.camera.position, 1.0f), frame.lightClusters.count, frame.lightClusters.depth };
+    GLintptr cameraOffset = writeUniforms(uniforms, &cameraUniforms, sizeof(CameraUniforms));
+
+    GridUniforms gridUniforms = { glm::vec4(frame.gridColor, 1.0f), glm::vec4(frame.gridSpacing, frame.gridFadeRadius, 0.0f, 0.0f) };
+    renderer.gridUniformOffset = writeUniforms(uniforms, &gridUniforms, sizeof(GridUniforms));
+    UniformAllocation objectUniforms;
+
+    if (objectSize > 0) {
+        objectUniforms = allocateUniforms(uniforms, objectSize);
+    }
+
+    recordModels(renderer, frame, objectUniforms);
+    writeImpostorUniforms(renderer, frame);
+    flushUniformFrame(uniforms, renderer.resources);
+
+    if (cameraOffset != -1) {
+        bindBufferRange(renderer.state, GL_UNIFORM_BUFFER, CAMERA_UNIFORM_BINDING, getResource(renderer.resources, uniforms.buffer), cameraOffset, sizeof(CameraUniforms));
+    }
+}
+
+void drawDepthPrepass(Renderer &renderer) {
+    GlState &state = renderer.state;
+    setCapability(state, GL_DEPTH_TEST, true);
+    setCapability(state, GL_BLEND, false);
+    useProgram(state, getResource(renderer.resources, renderer.depthShaderProgram));
+    setColorMask(state, false);
+    setDepthMask(state, true);
+    setDepthFunc(state, GL_LESS);
+
+    for (auto &commandBuffer : renderer.depthCommandBuffers) {
+        submitCommands(state, commandBuffer);
+    }
+}
+
+void drawModels(Renderer &renderer, Frame &frame) {
+    GlState &state = renderer.state;
+    setCapability(state, GL_DEPTH_TEST, true);
+    setCapability(state, GL_BLEND, false);
+
+    // With the pre-pass depth is already final, so only the front-most fragment gets shaded
+    int scope = beginGpuScope(renderer.profiler, "Models");
+    useProgram(state, renderer.shaderProgram);
+    setColorMask(state, true);
+    setDepthMask(state, !frame.isDepthPrepass);
+    setDepthFunc(state, frame.isDepthPrepass ? GL_EQUAL : GL_LESS);
+
+    for (auto &commandBuffer : renderer.commandBuffers) {
+        submitCommands(state, commandBuffer);
+    }
+
+    frame.stats.multiDrawCount = frame.isPulledDraw ? drawPulledModels(renderer, frame) : 0;
+    endGpuScope(renderer.profiler, scope);
+    setDepthFunc(state, GL_LESS);
+    setDepthMask(state, true);
 }
 
-void draw(SDL_Window* window, Renderer &renderer) {
-    SDL_GL_GetDrawableSize(window, &renderer.viewport.x, &renderer.viewport.y);
-    glViewport(0, 0, renderer.viewport.x, renderer.viewport.y);
-    glClearColor(renderer.clearColor.x, renderer.clearColor.y, renderer.clearColor.z, renderer.clearColor.w);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glUseProgram(renderer.shaderProgram);
-    glUniformMatrix4fv(0, 1, GL_FALSE, glm::value_ptr(getCameraProjection(renderer.camera, renderer.viewport)));
-    glUniformMatrix4fv(1, 1, GL_FALSE, glm::value_ptr(getCameraView(renderer.camera)));
-    glUniformMatrix4fv(2, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
-    drawModels(renderer);
-    renderGrid(renderer);
+void renderFrame(Renderer &renderer, Frame &frame) {
+    resetStateCounters(renderer.state);
+
+    // Resources belong to the render thread, the GUI only edits the setting that comes in with the frame
+    renderer.resources.budget = frame.memoryBudget;
+
+    // Until the requested variant finishes compiling the fallback keeps drawing
+    renderer.shaderProgram = getShaderVariant(renderer.permutations, frame.shaderFeatures);
+
+    // The pulled variant is compiled alongside, the last finished one keeps drawing while a new one compiles
+    if (frame.isVertexPulling) {
+        uint32_t features = frame.shaderFeatures | SHADER_FEATURE_VERTEX_PULLING;
+        GLuint program = getShaderVariant(renderer.permutations, features);
+
+        if (isShaderVariantReady(renderer.permutations, features)) {
+            renderer.pulling.program = program;
+            renderer.pulling.isReady = true;
+        }
+    }
+
+    // Copies go ahead of every draw, so a model whose last upload was issued here can already be drawn
+    processUploads(renderer.uploads, renderer.resources, renderer.state, frame.uploadBudget);
+    frame.drawList.erase(std::remove_if(frame.drawList.begin(), frame.drawList.end(), [&renderer, &frame](int instanceIndex) {
+        return !isUploadIssued(renderer.uploads, renderer.models[frame.instances[instanceIndex].model].uploadTicket);
+    }), frame.drawList.end());
+
+    glm::mat4 projection = getCameraProjection(frame.camera, frame.viewport);
+    glm::mat4 view = getCameraView(frame.camera);
+    prepareFrame(renderer, frame, projection, view);
+    uploadLights(renderer.lighting, renderer.resources, renderer.state, frame.lightClusters);
+    uploadTransforms(renderer.transformBuffer, renderer.resources, renderer.state, frame.transformUpdates, frame.transformCount);
+    updateTextureStreaming(renderer.streaming, renderer.resources, renderer.state, frame.textureRequests, frame.textureBudget);
+
+    // A scaled frame renders into the corner of viewport-sized attachments, so scale changes never reallocate
+    glm::ivec2 renderSize = getScaledSize(frame.viewport, frame.resolutionScale);
+    bool isScaled = renderSize != frame.viewport;
+    FrameGraph &graph = renderer.frameGraph;
+    beginFrameGraph(graph);
+    int output = importGraphAttachment(graph, "Output", renderer.outputFramebuffer);
+    int sceneColor = isScaled ? createGraphAttachment(graph, "Scene Color", frame.viewport, GL_RGBA8) : output;
+    int sceneDepth = isScaled ? createGraphAttachment(graph, "Scene Depth", frame.viewport, GL_DEPTH_COMPONENT24) : output;
+
+    if (frame.isDepthPrepass) {
+        addGraphPass(graph, "Depth Prepass", {}, { sceneDepth }, [&renderer, renderSize]() {
+            setViewport(renderer.state, glm::ivec4(0, 0, renderSize.x, renderSize.y));
+            setDepthMask(renderer.state, true);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            drawDepthPrepass(renderer);
+        });
+    }
+
+    // Without the pre-pass this is the first pass touching depth, so it clears that too
+    std::vector<int> sceneReads = frame.isDepthPrepass ? std::vector<int>{ sceneDepth } : std::vector<int>();
+    addGraphPass(graph, "Scene", sceneReads, { sceneColor, sceneDepth }, [&renderer, &frame, renderSize]() {
+        setViewport(renderer.state, glm::ivec4(0, 0, renderSize.x, renderSize.y));
+        setClearColor(renderer.state, frame.clearColor);
+        setColorMask(renderer.state, true);
+        setDepthMask(renderer.state, true);
+        glClear(frame.isDepthPrepass ? GL_COLOR_BUFFER_BIT : GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        drawModels(renderer, frame);
+
+        if (!frame.impostorSlots.empty()) {
+            int scope = beginGpuScope(renderer.profiler, "Impostors");
+            drawImpostors(renderer, frame);
+            endGpuScope(renderer.profiler, scope);
+        }
+
+        if (renderer.gridUniformOffset != -1) {
+            int scope = beginGpuScope(renderer.profiler, "Grid");
+            renderGrid(renderer);
+            endGpuScope(renderer.profiler, scope);
+        }
+    });
+
+    if (isScaled) {
+        addGraphPass(graph, "Upscale", { sceneColor }, { output }, [&renderer, &frame, renderSize, sceneColor]() {
+            GLuint source = getGraphFramebuffer(renderer.frameGraph, renderer.resources, renderer.state, { sceneColor });
+            bindFramebuffer(renderer.state, GL_READ_FRAMEBUFFER, source);
+            bindFramebuffer(renderer.state, GL_DRAW_FRAMEBUFFER, renderer.outputFramebuffer);
+            glBlitFramebuffer(0, 0, renderSize.x, renderSize.y, 0, 0, frame.viewport.x, frame.viewport.y, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+            bindFramebuffer(renderer.state, GL_FRAMEBUFFER, renderer.outputFramebuffer);
+            setViewport(renderer.state, glm::ivec4(0, 0, frame.viewport.x, frame.viewport.y));
+        });
+    }
+
+    executeFrameGraph(graph, renderer.resources, renderer.state, renderer.profiler);
+    endUniformFrame(renderer.uniforms);
+
+    // Deleted names can be handed out again, so nothing cached may still refer to them
+    if (retireResources(renderer.resources) > 0) {
+        invalidateState(renderer.state);
+    }
+
+    frame.stats.issuedCount = renderer.state.issuedCount;
+    frame.stats.elidedCount = renderer.state.elidedCount;
+    frame.stats.uniformSize = renderer.uniforms.usedSize;
+    frame.stats.uniformFrameSize = renderer.uniforms.frameSize;
+    frame.stats.renderSize = renderSize;
+    frame.stats.textureSize = renderer.streaming.residentSize;
+    frame.stats.textureBudget = frame.textureBudget;
+    frame.stats.pendingShaderCount = renderer.permutations.pendingCount;
+    frame.stats.isPulledReady = renderer.pulling.isReady;
+    frame.stats.shaderCacheHitCount = shaderCache.hitCount;
+    frame.stats.shaderCacheMissCount = shaderCache.missCount;
+    frame.stats.transformSize = renderer.transformBuffer.uploadedSize;
+    frame.stats.impostorCount = (int) frame.impostorSlots.size();
+    frame.stats.retiringSize = renderer.resources.retiringSize;
+    frame.stats.uploadSize = renderer.uploads.uploadedSize;
+    frame.stats.pendingUploadSize = renderer.uploads.pendingSize;
+    frame.stats.transientSize = graph.allocatedSize;
+    frame.stats.transientRequestedSize = graph.requestedSize;
+    frame.stats.graphPassCount = (int) graph.passes.size();
+    frame.stats.culledPassCount = graph.culledCount;
+
+    for (int a = 0; a < RESOURCE_TYPE_COUNT; ++a) {
+        frame.stats.resourceSizes[a] = renderer.resources.sizes[a];
+        frame.stats.resourceCounts[a] = renderer.resources.counts[a];
+    }
 }
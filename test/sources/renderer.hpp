@@ -4,10 +4,10 @@
 #include <sstream>
 #include <string>
 #include <string_view>
-#include <regex>
 #include <algorithm>
 #include <vector>
 #include <map>
+#include <thread>
 #include <glad/glad.h>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_opengl.h>
@@ -19,11 +19,34 @@
 #include <glm/ext/matrix_clip_space.hpp>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "jobs.hpp"
+#include "resources.hpp"
+#include "uploads.hpp"
+#include "culling.hpp"
+#include "uniforms.hpp"
+#include "state.hpp"
+#include "commands.hpp"
+#include "profiler.hpp"
+#include "resolution.hpp"
+#include "lighting.hpp"
+#include "streaming.hpp"
+#include "shaders.hpp"
+#include "permutations.hpp"
+#include "geometry.hpp"
+#include "transforms.hpp"
+#include "pulling.hpp"
+#include "impostors.hpp"
+#include "framegraph.hpp"
+
+const GLuint CAMERA_UNIFORM_BINDING = 0;
+
+const GLuint OBJECT_UNIFORM_BINDING = 1;
 
 struct BufferView {
     int buffer;
     int byteLength;
-    int byteOffset;
+    int byteOffset = 0;
+    int byteStride = 0;
 };
 
 struct Accessor {
@@ -31,6 +54,8 @@ struct Accessor {
     int componentType;
     int count;
     std::string type;
+    int byteOffset = 0;
+    bool isNormalized = false;
 };
 
 struct PrimitiveAttribute {
@@ -41,7 +66,7 @@ struct PrimitiveAttribute {
 struct MeshPrimitive {
     std::vector<PrimitiveAttribute> attributes;
     int indices;
-    int material;
+    int material = -1;
 };
 
 struct Mesh {
@@ -49,6 +74,20 @@ struct Mesh {
     std::vector<MeshPrimitive> primitives;
 };
 
+struct Image {
+    int bufferView = -1;
+    std::string mimeType;
+};
+
+struct Texture {
+    int source = -1;
+};
+
+struct Material {
+    std::string name;
+    int baseColorTexture = -1;
+};
+
 struct Node {
     std::string name;
     int mesh = -1;
@@ -67,16 +106,30 @@ struct Model {
     std::vector<Mesh> meshes;
     std::vector<Accessor> accessors;
     std::vector<BufferView> bufferViews;
+    std::vector<Image> images;
+    std::vector<Texture> textures;
+    std::vector<Material> materials;
+    std::vector<TextureHandle> textureHandles;
     std::vector<char> buffer;
-    GLuint vao;
+    ResourceHandle vao;
+    ResourceHandle depthVao;
+    int drawCount = 0;
+    std::vector<ResourceHandle> buffers;
+    ResourceHandle indexBuffer;
+    uint64_t uploadTicket = 0;
+    int pulledMesh = -1;
+    int impostor = -1;
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    OccluderMesh occluder;
 };
 
 struct Grid {
-    GLuint shaderProgram;
+    ResourceHandle shaderProgram;
     glm::vec3 color = glm::vec3(0.0f, 0.0f, 0.0f);
-    GLuint vao;
-    GLuint positionBuffer;
-    GLuint uvBuffer;
+    float spacing = 0.5f;
+    float fadeRadius = 150.0f;
+    ResourceHandle vao;
 };
 
 struct Camera {
@@ -94,13 +147,131 @@ struct Camera {
     float sensitivity = 0.1f;
 };
 
+struct CameraUniforms {
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::vec4 position;
+    glm::vec4 clusterCount;
+    glm::vec4 clusterDepth;
+};
+
+struct ObjectUniforms {
+    glm::vec4 material;
+};
+
+struct GridUniforms {
+    glm::vec4 color;
+    glm::vec4 parameters;
+};
+
+struct Instance {
+    int model;
+    glm::mat4 matrix = glm::mat4(1.0f);
+    int transform = -1;
+};
+
+struct RenderStats {
+    int issuedCount = 0;
+    int elidedCount = 0;
+    GLsizeiptr uniformSize = 0;
+    GLsizeiptr uniformFrameSize = 0;
+    std::vector<GpuTiming> timings;
+    glm::ivec2 renderSize = glm::ivec2(0, 0);
+    GLuint viewportTexture = 0;
+    GLsizeiptr textureSize = 0;
+    GLsizeiptr textureBudget = 0;
+    int pendingShaderCount = 0;
+    bool isPulledReady = false;
+    int shaderCacheHitCount = 0;
+    int shaderCacheMissCount = 0;
+    GLsizeiptr transformSize = 0;
+    int multiDrawCount = 0;
+    int impostorCount = 0;
+    GLsizeiptr resourceSizes[RESOURCE_TYPE_COUNT] = {};
+    int resourceCounts[RESOURCE_TYPE_COUNT] = {};
+    GLsizeiptr retiringSize = 0;
+    GLsizeiptr uploadSize = 0;
+    GLsizeiptr pendingUploadSize = 0;
+    GLsizeiptr transientSize = 0;
+    GLsizeiptr transientRequestedSize = 0;
+    int graphPassCount = 0;
+    int culledPassCount = 0;
+};
+
+struct Frame {
+    Camera camera;
+    glm::ivec2 viewport = glm::ivec2(1920, 1080);
+    glm::ivec2 windowSize = glm::ivec2(1920, 1080);
+    bool isViewportPanel = false;
+    glm::vec4 clearColor;
+    glm::vec3 gridColor;
+    float gridSpacing;
+    float gridFadeRadius;
+    std::vector<Instance> instances;
+    std::vector<TransformUpdate> transformUpdates;
+    int transformCount = 0;
+    std::vector<int> drawList;
+    std::vector<GLuint> impostorSlots;
+    std::vector<ImpostorBatch> impostorBatches;
+    std::vector<int> textureRequests;
+    GLsizeiptr textureBudget = 0;
+    GLsizeiptr uploadBudget = 0;
+    GLsizeiptr memoryBudget = 0;
+    bool isDepthPrepass = false;
+    bool isVertexPulling = false;
+    bool isPulledDraw = false;
+    uint32_t shaderFeatures = SHADER_FEATURES_DEFAULT;
+    int swapInterval = 1;
+    float resolutionScale = 1.0f;
+    LightClusters lightClusters;
+    RenderStats stats;
+};
+
 struct Renderer {
     glm::ivec2 viewport = glm::ivec2(1920, 1080);
+    glm::ivec2 windowSize = glm::ivec2(1920, 1080);
+    glm::ivec2 panelSize = glm::ivec2(1, 1);
+    bool isViewportPanel = true;
+    RenderTarget viewportTarget;
     glm::vec4 clearColor = glm::vec4(1.0f, 1.0, 1.0f, 1.0f);
     GLuint shaderProgram;
+    ResourceHandle depthShaderProgram;
+    ShaderPermutations permutations;
+    uint32_t shaderFeatures = SHADER_FEATURES_DEFAULT;
+    bool isDepthPrepass = false;
+    bool isVertexPulling = false;
+    VertexPulling pulling;
+    Impostors impostors;
     Camera camera;
     Grid grid;
     std::vector<Model> models;
+    std::vector<Instance> instances;
+    std::vector<Instance> entityInstances;
+    TransformSlots transformSlots;
+    TransformBuffer transformBuffer;
+    Jobs jobs;
+    Occlusion occlusion;
+    int maxOccluderTriangles = 4096;
+    Resources resources;
+    GLsizeiptr memoryBudget = (GLsizeiptr) 1024 << 20;
+    Uploads uploads;
+    UniformRing uniforms;
+    GLintptr gridUniformOffset = -1;
+    GlState state;
+    std::vector<CommandBuffer> commandBuffers;
+    std::vector<CommandBuffer> depthCommandBuffers;
+    std::vector<int> drawOffsets;
+    int minCommandSlice = 64;
+    Profiler profiler;
+    ResolutionScale resolution;
+    FrameGraph frameGraph;
+    GLuint outputFramebuffer = 0;
+    int swapInterval = 1;
+    int appliedSwapInterval = 1;
+    Lighting lighting;
+    ResourceHandle defaultTexture;
+    TextureStreaming streaming;
+    RenderStats stats;
 };
 
 struct Transform {
@@ -120,7 +291,9 @@ GLenum getShaderType(const std::string &type);
 
 GLuint createShaderProgram(const std::map<std::string, std::string> &typeSourceMap);
 
-GLuint loadShaderProgram(const std::string &path);
+GLuint loadShaderProgram(const std::string &path, const ShaderDefines &defines = {});
+
+void bindUniformBlocks(GLuint program);
 
 void updateCamera(Camera &camera);
 
@@ -132,16 +305,56 @@ glm::mat4 getCameraProjection(const Camera &camera, const glm::vec2 &viewport);
 
 glm::mat4 getCameraView(const Camera &camera);
 
-Grid createGrid();
+Grid createGrid(Resources &resources);
 
-void renderGrid(const Renderer &renderer);
+void renderGrid(Renderer &renderer);
 
 int getComponentCount(const std::string &type);
 
+int getComponentSize(int componentType);
+
+int getAttributeLocation(const std::string &key);
+
+const char* getAccessorData(const Model &model, const Accessor &accessor);
+
+int getAccessorStride(const Model &model, const Accessor &accessor);
+
+int findAttribute(const MeshPrimitive &meshPrimitive, const std::string &key);
+
+bool isOccluderMesh(const Mesh &mesh);
+
+uint32_t getIndex(const char* data, int componentType, int index);
+
 int loadModel(Model &model, const std::string &path);
 
-void bindModel(Model &model);
+void computeBounds(Model &model);
+
+void loadModelTextures(Renderer &renderer, Model &model);
+
+TextureHandle getMaterialHandle(const Model &model, int material);
+
+GLuint getPageTexture(const Renderer &renderer, const TextureHandle &handle);
+
+void createOccluder(Model &model, int maxTriangleCount);
+
+void bindModel(Renderer &renderer, Model &model);
+
+void destroyModel(Model &model, Resources &resources);
+
+void cullInstances(Renderer &renderer, Frame &frame, const glm::mat4 &viewProjection);
+
+void requestTextureLevels(Renderer &renderer, Frame &frame);
+
+void sortFrontToBack(Renderer &renderer, Frame &frame);
+
+void buildFrame(Renderer &renderer, Frame &frame);
+
+void recordModels(Renderer &renderer, const Frame &frame, const UniformAllocation &objectUniforms);
+
+void prepareFrame(Renderer &renderer, const Frame &frame, const glm::mat4 &projection, const glm::mat4 &view);
+
+void drawDepthPrepass(Renderer &renderer);
 
-void drawModels(Renderer &renderer);
+void drawModels(Renderer &renderer, Frame &frame);
 
-void draw(SDL_Window* window, Renderer &renderer);
+void renderFrame(Renderer &renderer, Frame &frame);
@@ -0,0 +1,84 @@
+#include "resolution.hpp"
+
+int resizeRenderTarget(RenderTarget &target, Resources &resources, const glm::ivec2 &size) {
+    bool isCreated = isResourceAlive(resources, target.framebuffer);
+
+    if (isCreated && target.size == size) {
+        return 0;
+    }
+
+    // Storage is respecified in place, so anything holding the texture name (like an ImGui image) stays valid
+    target.size = size;
+
+    if (!isCreated) {
+        target.colorTexture = createResource(resources, ResourceType::Texture);
+        target.depthRenderbuffer = createResource(resources, ResourceType::Renderbuffer);
+        target.framebuffer = createResource(resources, ResourceType::Framebuffer);
+    }
+
+    setResourceSize(resources, target.colorTexture, (GLsizeiptr) size.x * size.y * 4);
+    setResourceSize(resources, target.depthRenderbuffer, (GLsizeiptr) size.x * size.y * 4);
+    glBindTexture(GL_TEXTURE_2D, getResource(resources, target.colorTexture));
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, getResource(resources, target.depthRenderbuffer));
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, size.x, size.y);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    GLint lastFramebuffer;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &lastFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, getResource(resources, target.framebuffer));
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, getResource(resources, target.colorTexture), 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, getResource(resources, target.depthRenderbuffer));
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, lastFramebuffer);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "Render target framebuffer incomplete: " << status << std::endl;
+        destroyRenderTarget(target, resources);
+
+        return -1;
+    }
+
+    return 0;
+}
+
+void destroyRenderTarget(RenderTarget &target, Resources &resources) {
+    releaseResource(resources, target.framebuffer);
+    releaseResource(resources, target.depthRenderbuffer);
+    releaseResource(resources, target.colorTexture);
+    target = RenderTarget();
+}
+
+glm::ivec2 getScaledSize(const glm::ivec2 &size, float scale) {
+    return glm::max(glm::ivec2(glm::vec2(size) * scale), glm::ivec2(1, 1));
+}
+
+float getGpuMilliseconds(const std::vector<GpuTiming> &timings) {
+    float milliseconds = 0.0f;
+
+    // Nested scopes are already counted by their parents
+    for (auto &timing : timings) {
+        if (timing.depth == 0) {
+            milliseconds += timing.milliseconds;
+        }
+    }
+
+    return milliseconds;
+}
+
+void updateResolutionScale(ResolutionScale &resolution, float gpuMilliseconds) {
+    resolution.minScale = glm::clamp(resolution.minScale, 0.1f, 1.0f);
+    resolution.maxScale = glm::clamp(resolution.maxScale, resolution.minScale, 1.0f);
+
+    if (gpuMilliseconds > 0.0f) {
+        // Fill cost follows the pixel count, so the linear scale moves with the square root of the budget ratio
+        float scale = resolution.scale * sqrtf(resolution.targetMilliseconds / gpuMilliseconds);
+        resolution.scale += (scale - resolution.scale) * resolution.responsiveness;
+    }
+
+    resolution.scale = glm::clamp(resolution.scale, resolution.minScale, resolution.maxScale);
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/vec2.hpp>
+#include <glm/common.hpp>
+#include "profiler.hpp"
+#include "resources.hpp"
+
+struct RenderTarget {
+    ResourceHandle framebuffer;
+    ResourceHandle colorTexture;
+    ResourceHandle depthRenderbuffer;
+    glm::ivec2 size = glm::ivec2(0, 0);
+};
+
+struct ResolutionScale {
+    bool isEnabled = false;
+    float scale = 1.0f;
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+    float targetMilliseconds = 16.0f;
+    float responsiveness = 0.1f;
+};
+
+int resizeRenderTarget(RenderTarget &target, Resources &resources, const glm::ivec2 &size);
+
+void destroyRenderTarget(RenderTarget &target, Resources &resources);
+
+glm::ivec2 getScaledSize(const glm::ivec2 &size, float scale);
+
+float getGpuMilliseconds(const std::vector<GpuTiming> &timings);
+
+void updateResolutionScale(ResolutionScale &resolution, float gpuMilliseconds);
@@ -0,0 +1,204 @@
+#include "resources.hpp"
+
+const char* RESOURCE_TYPE_NAMES[RESOURCE_TYPE_COUNT] = { "Buffers", "Textures", "Vertex Arrays", "Programs", "Renderbuffers", "Framebuffers" };
+
+GLuint generateObject(ResourceType type) {
+    GLuint object = 0;
+
+    switch (type) {
+        case ResourceType::Buffer:
+            glGenBuffers(1, &object);
+            break;
+        case ResourceType::Texture:
+            glGenTextures(1, &object);
+            break;
+        case ResourceType::VertexArray:
+            glGenVertexArrays(1, &object);
+            break;
+        case ResourceType::Program:
+            object = glCreateProgram();
+            break;
+        case ResourceType::Renderbuffer:
+            glGenRenderbuffers(1, &object);
+            break;
+        case ResourceType::Framebuffer:
+            glGenFramebuffers(1, &object);
+            break;
+    }
+
+    return object;
+}
+
+void deleteObject(ResourceType type, GLuint object) {
+    switch (type) {
+        case ResourceType::Buffer:
+            glDeleteBuffers(1, &object);
+            break;
+        case ResourceType::Texture:
+            glDeleteTextures(1, &object);
+            break;
+        case ResourceType::VertexArray:
+            glDeleteVertexArrays(1, &object);
+            break;
+        case ResourceType::Program:
+            glDeleteProgram(object);
+            break;
+        case ResourceType::Renderbuffer:
+            glDeleteRenderbuffers(1, &object);
+            break;
+        case ResourceType::Framebuffer:
+            glDeleteFramebuffers(1, &object);
+            break;
+    }
+}
+
+ResourceHandle createResource(Resources &resources, ResourceType type) {
+    return adoptResource(resources, type, generateObject(type));
+}
+
+ResourceHandle adoptResource(Resources &resources, ResourceType type, GLuint object) {
+    ResourceHandle handle;
+
+    if (!object) {
+        return handle;
+    }
+
+    if (resources.freeSlots.empty()) {
+        handle.index = (uint32_t) resources.slots.size();
+        resources.slots.emplace_back();
+    } else {
+        handle.index = resources.freeSlots.back();
+        resources.freeSlots.pop_back();
+    }
+
+    ResourceSlot &slot = resources.slots[handle.index];
+    slot.object = object;
+    slot.type = type;
+    slot.size = 0;
+    handle.generation = slot.generation;
+    resources.counts[(int) type]++;
+
+    return handle;
+}
+
+GLuint getResource(const Resources &resources, ResourceHandle handle) {
+    if (handle.index >= resources.slots.size() || resources.slots[handle.index].generation != handle.generation) {
+        return 0;
+    }
+
+    return resources.slots[handle.index].object;
+}
+
+bool isResourceAlive(const Resources &resources, ResourceHandle handle) {
+    return getResource(resources, handle) != 0;
+}
+
+void setResourceSize(Resources &resources, ResourceHandle handle, GLsizeiptr size) {
+    if (!isResourceAlive(resources, handle)) {
+        return;
+    }
+
+    ResourceSlot &slot = resources.slots[handle.index];
+    GLsizeiptr total = getTotalResourceSize(resources) - slot.size + size;
+
+    if (total > resources.budget && getTotalResourceSize(resources) <= resources.budget) {
+        std::cout << "GPU memory over budget: " << total / (1024 * 1024) << " / " << resources.budget / (1024 * 1024) << " MB" << std::endl;
+    }
+
+    resources.sizes[(int) slot.type] += size - slot.size;
+    slot.size = size;
+}
+
+void releaseResource(Resources &resources, ResourceHandle &handle) {
+    if (!isResourceAlive(resources, handle)) {
+        handle = ResourceHandle();
+
+        return;
+    }
+
+    // The slot can be reused right away, the object itself waits for the frame's fence
+    ResourceSlot &slot = resources.slots[handle.index];
+    resources.released.push_back({ slot.object, slot.type, slot.size });
+    resources.retiringSize += slot.size;
+    slot.object = 0;
+    slot.size = 0;
+    slot.generation++;
+    resources.freeSlots.push_back(handle.index);
+    handle = ResourceHandle();
+}
+
+void deleteReleased(Resources &resources, std::vector<ReleasedResource> &released) {
+    for (auto &resource : released) {
+        deleteObject(resource.type, resource.object);
+        resources.sizes[(int) resource.type] -= resource.size;
+        resources.counts[(int) resource.type]--;
+        resources.retiringSize -= resource.size;
+    }
+
+    released.clear();
+}
+
+int retireResources(Resources &resources) {
+    // Fences signal in submission order, so the first one still pending ends the scan
+    size_t retiredCount = 0;
+    int deletedCount = 0;
+
+    for (; retiredCount < resources.retirements.size(); ++retiredCount) {
+        ResourceRetirement &retirement = resources.retirements[retiredCount];
+        GLenum status = glClientWaitSync(retirement.fence, 0, 0);
+
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+
+        glDeleteSync(retirement.fence);
+        deletedCount += (int) retirement.resources.size();
+        deleteReleased(resources, retirement.resources);
+    }
+
+    resources.retirements.erase(resources.retirements.begin(), resources.retirements.begin() + retiredCount);
+
+    if (!resources.released.empty()) {
+        ResourceRetirement retirement;
+        retirement.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        retirement.resources.swap(resources.released);
+        resources.retirements.push_back(std::move(retirement));
+    }
+
+    return deletedCount;
+}
+
+GLsizeiptr getTotalResourceSize(const Resources &resources) {
+    GLsizeiptr total = 0;
+
+    for (auto size : resources.sizes) {
+        total += size;
+    }
+
+    return total;
+}
+
+void destroyResources(Resources &resources) {
+    for (auto &retirement : resources.retirements) {
+        glDeleteSync(retirement.fence);
+        deleteReleased(resources, retirement.resources);
+    }
+
+    deleteReleased(resources, resources.released);
+    resources.retirements.clear();
+    int leakedCount = 0;
+
+    // Whatever is still alive here was never released by its owner
+    for (auto &slot : resources.slots) {
+        if (slot.object) {
+            deleteObject(slot.type, slot.object);
+            leakedCount++;
+        }
+    }
+
+    if (leakedCount > 0) {
+        std::cout << "Deleted " << leakedCount << " GPU resources that were never released" << std::endl;
+    }
+
+    resources = Resources();
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <iostream>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <glad/glad.h>
+
+enum class ResourceType {
+    Buffer,
+    Texture,
+    VertexArray,
+    Program,
+    Renderbuffer,
+    Framebuffer
+};
+
+const int RESOURCE_TYPE_COUNT = 6;
+extern const char* RESOURCE_TYPE_NAMES[RESOURCE_TYPE_COUNT];
+
+// Slot plus the generation it was issued at, a released slot moves on a generation so stale copies stop resolving
+struct ResourceHandle {
+    uint32_t index = 0;
+    uint32_t generation = 0;
+};
+
+struct ResourceSlot {
+    GLuint object = 0;
+    ResourceType type = ResourceType::Buffer;
+    uint32_t generation = 1;
+    GLsizeiptr size = 0;
+};
+
+struct ReleasedResource {
+    GLuint object;
+    ResourceType type;
+    GLsizeiptr size;
+};
+
+// Everything released during one frame, deleted once the GPU is past that frame's fence
+struct ResourceRetirement {
+    GLsync fence = nullptr;
+    std::vector<ReleasedResource> resources;
+};
+
+// Owned by the thread holding the context. Slots never move, so long-lived handles can still be resolved elsewhere
+struct Resources {
+    std::deque<ResourceSlot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::vector<ReleasedResource> released;
+    std::vector<ResourceRetirement> retirements;
+    GLsizeiptr sizes[RESOURCE_TYPE_COUNT] = {};
+    int counts[RESOURCE_TYPE_COUNT] = {};
+    GLsizeiptr retiringSize = 0;
+    GLsizeiptr budget = (GLsizeiptr) 1024 << 20;
+};
+
+ResourceHandle createResource(Resources &resources, ResourceType type);
+
+ResourceHandle adoptResource(Resources &resources, ResourceType type, GLuint object);
+
+GLuint getResource(const Resources &resources, ResourceHandle handle);
+
+bool isResourceAlive(const Resources &resources, ResourceHandle handle);
+
+void setResourceSize(Resources &resources, ResourceHandle handle, GLsizeiptr size);
+
+void releaseResource(Resources &resources, ResourceHandle &handle);
+
+int retireResources(Resources &resources);
+
+GLsizeiptr getTotalResourceSize(const Resources &resources);
+
+void destroyResources(Resources &resources);
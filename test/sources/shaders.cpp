@@ -0,0 +1,164 @@
+#include "renderer.hpp"
+
+ShaderCache shaderCache;
+
+uint64_t hashBytes(uint64_t hash, const std::string &bytes) {
+    for (auto byte : bytes) {
+        hash ^= (unsigned char) byte;
+        hash *= 0x100000001b3ull;
+    }
+
+    // Separator so neighbouring strings can't shift into each other
+    hash ^= 0xff;
+    hash *= 0x100000001b3ull;
+
+    return hash;
+}
+
+std::string getCachePath(const ShaderCache &cache, uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long) key);
+
+    return cache.directory + name;
+}
+
+void initShaderCache(ShaderCache &cache, const std::string &directory) {
+    GLint formatCount = 0;
+
+    if (GLAD_GL_ARB_get_program_binary) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    }
+
+    cache.isEnabled = formatCount > 0;
+
+    if (!cache.isEnabled) {
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    if (error) {
+        std::cout << "Failed to create shader cache directory: " << error.message() << std::endl;
+        cache.isEnabled = false;
+
+        return;
+    }
+
+    // Binaries are only valid for the exact driver that produced them
+    cache.directory = directory;
+    cache.driver = std::string((const char*) glGetString(GL_VENDOR)) + "|" + (const char*) glGetString(GL_RENDERER) + "|" + (const char*) glGetString(GL_VERSION);
+}
+
+uint64_t hashProgramSources(const ShaderCache &cache, const std::map<std::string, std::string> &typeSourceMap, const std::string &defines) {
+    uint64_t hash = hashBytes(0xcbf29ce484222325ull, cache.driver);
+    hash = hashBytes(hash, defines);
+
+    for (auto &[type, source] : typeSourceMap) {
+        hash = hashBytes(hash, type);
+        hash = hashBytes(hash, source);
+    }
+
+    return hash;
+}
+
+GLuint loadCachedProgram(ShaderCache &cache, uint64_t key) {
+    std::string path = getCachePath(cache, key);
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file.is_open()) {
+        return GL_FALSE;
+    }
+
+    uint32_t magic = 0;
+    uint32_t driverLength = 0;
+    GLenum format = 0;
+    GLsizei length = 0;
+    file.read((char*) &magic, sizeof(magic));
+    file.read((char*) &driverLength, sizeof(driverLength));
+
+    std::string driver(driverLength, '\0');
+    file.read(driver.data(), driverLength);
+    file.read((char*) &format, sizeof(format));
+    file.read((char*) &length, sizeof(length));
+
+    std::vector<char> binary(std::max(length, 0));
+    file.read(binary.data(), binary.size());
+
+    if (!file || magic != SHADER_CACHE_MAGIC || driver != cache.driver || length <= 0) {
+        file.close();
+        std::filesystem::remove(path);
+
+        return GL_FALSE;
+    }
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, format, binary.data(), length);
+
+    GLint linkStatus = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+
+    // Drivers may reject a binary at any time, the caller then just compiles from source
+    if (!linkStatus) {
+        glDeleteProgram(program);
+        file.close();
+        std::filesystem::remove(path);
+
+        return GL_FALSE;
+    }
+
+    return program;
+}
+
+void storeCachedProgram(ShaderCache &cache, uint64_t key, GLuint program) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+
+    if (length <= 0) {
+        return;
+    }
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    std::ofstream file(getCachePath(cache, key), std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open()) {
+        std::cout << "Failed to write shader cache entry" << std::endl;
+
+        return;
+    }
+
+    uint32_t driverLength = (uint32_t) cache.driver.size();
+    file.write((const char*) &SHADER_CACHE_MAGIC, sizeof(SHADER_CACHE_MAGIC));
+    file.write((const char*) &driverLength, sizeof(driverLength));
+    file.write(cache.driver.data(), driverLength);
+    file.write((const char*) &format, sizeof(format));
+    file.write((const char*) &length, sizeof(length));
+    file.write(binary.data(), length);
+}
+
+GLuint createCachedProgram(ShaderCache &cache, const std::map<std::string, std::string> &typeSourceMap, const std::string &defines) {
+    if (!cache.isEnabled) {
+        return createShaderProgram(typeSourceMap);
+    }
+
+    uint64_t key = hashProgramSources(cache, typeSourceMap, defines);
+    GLuint program = loadCachedProgram(cache, key);
+
+    if (program) {
+        cache.hitCount++;
+
+        return program;
+    }
+
+    cache.missCount++;
+    program = createShaderProgram(typeSourceMap);
+
+    if (program) {
+        storeCachedProgram(cache, key, program);
+    }
+
+    return program;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "preprocessor.hpp"
+
+const uint32_t SHADER_CACHE_MAGIC = 0x43425053;
+
+struct ShaderCache {
+    bool isEnabled = false;
+    std::string directory;
+    std::string driver;
+    int hitCount = 0;
+    int missCount = 0;
+    ShaderFiles files;
+};
+
+extern ShaderCache shaderCache;
+
+void initShaderCache(ShaderCache &cache, const std::string &directory);
+
+uint64_t hashProgramSources(const ShaderCache &cache, const std::map<std::string, std::string> &typeSourceMap, const std::string &defines);
+
+GLuint loadCachedProgram(ShaderCache &cache, uint64_t key);
+
+void storeCachedProgram(ShaderCache &cache, uint64_t key, GLuint program);
+
+GLuint createCachedProgram(ShaderCache &cache, const std::map<std::string, std::string> &typeSourceMap, const std::string &defines = "");
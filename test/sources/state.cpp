@@ -0,0 +1,233 @@
+#include "state.hpp"
+
+bool isStateChanged(GlState &state, bool isChanged) {
+    if (isChanged) {
+        state.issuedCount++;
+    } else {
+        state.elidedCount++;
+    }
+
+    return isChanged;
+}
+
+int getBufferSlot(GLenum target) {
+    switch (target) {
+        case GL_ARRAY_BUFFER: return 0;
+        case GL_ELEMENT_ARRAY_BUFFER: return 1;
+        case GL_UNIFORM_BUFFER: return 2;
+        case GL_COPY_READ_BUFFER: return 3;
+        case GL_COPY_WRITE_BUFFER: return 4;
+        case GL_PIXEL_PACK_BUFFER: return 5;
+        case GL_PIXEL_UNPACK_BUFFER: return 6;
+        case GL_TEXTURE_BUFFER: return 7;
+    }
+
+    return -1;
+}
+
+int getCapabilitySlot(GLenum capability) {
+    switch (capability) {
+        case GL_DEPTH_TEST: return 0;
+        case GL_BLEND: return 1;
+        case GL_CULL_FACE: return 2;
+        case GL_SCISSOR_TEST: return 3;
+        case GL_STENCIL_TEST: return 4;
+    }
+
+    return -1;
+}
+
+void invalidateState(GlState &state) {
+    GlState invalid;
+    invalid.issuedCount = state.issuedCount;
+    invalid.elidedCount = state.elidedCount;
+
+    for (auto &buffer : invalid.buffers) {
+        buffer = UNKNOWN_STATE;
+    }
+
+    for (int a = 0; a < STATE_TEXTURE_UNIT_COUNT; ++a) {
+        invalid.textures[a] = UNKNOWN_STATE;
+        invalid.textureTargets[a] = UNKNOWN_STATE;
+    }
+
+    for (auto &capability : invalid.capabilities) {
+        capability = -1;
+    }
+
+    state = invalid;
+}
+
+void resetStateCounters(GlState &state) {
+    state.issuedCount = 0;
+    state.elidedCount = 0;
+}
+
+void useProgram(GlState &state, GLuint program) {
+    if (isStateChanged(state, state.program != program)) {
+        glUseProgram(program);
+        state.program = program;
+    }
+}
+
+void bindVertexArray(GlState &state, GLuint vertexArray) {
+    if (isStateChanged(state, state.vertexArray != vertexArray)) {
+        glBindVertexArray(vertexArray);
+        state.vertexArray = vertexArray;
+
+        // Element array binding is part of the vertex array object
+        state.buffers[getBufferSlot(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN_STATE;
+    }
+}
+
+void bindBuffer(GlState &state, GLenum target, GLuint buffer) {
+    int slot = getBufferSlot(target);
+
+    if (slot == -1) {
+        glBindBuffer(target, buffer);
+        state.issuedCount++;
+
+        return;
+    }
+
+    if (isStateChanged(state, state.buffers[slot] != buffer)) {
+        glBindBuffer(target, buffer);
+        state.buffers[slot] = buffer;
+    }
+}
+
+void bindBufferRange(GlState &state, GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    if (target != GL_UNIFORM_BUFFER || index >= STATE_BUFFER_BINDING_COUNT) {
+        glBindBufferRange(target, index, buffer, offset, size);
+        state.issuedCount++;
+
+        return;
+    }
+
+    BufferRange &range = state.uniformBuffers[index];
+
+    if (isStateChanged(state, range.buffer != buffer || range.offset != offset || range.size != size)) {
+        glBindBufferRange(target, index, buffer, offset, size);
+        range.buffer = buffer;
+        range.offset = offset;
+        range.size = size;
+
+        // Indexed binding also replaces the generic binding point
+        state.buffers[getBufferSlot(target)] = buffer;
+    }
+}
+
+void bindTexture(GlState &state, GLuint unit, GLenum target, GLuint texture) {
+    if (unit >= STATE_TEXTURE_UNIT_COUNT) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, texture);
+        state.activeTexture = GL_TEXTURE0 + unit;
+        state.issuedCount += 2;
+
+        return;
+    }
+
+    if (!isStateChanged(state, state.textures[unit] != texture || state.textureTargets[unit] != target)) {
+        return;
+    }
+
+    if (isStateChanged(state, state.activeTexture != GL_TEXTURE0 + unit)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        state.activeTexture = GL_TEXTURE0 + unit;
+    }
+
+    glBindTexture(target, texture);
+    state.textures[unit] = texture;
+    state.textureTargets[unit] = target;
+}
+
+void bindTextureForEdit(GlState &state, GLuint unit, GLenum target, GLuint texture) {
+    // glTex* calls act on the active unit, which an elided bind would leave wherever it was
+    if (unit < STATE_TEXTURE_UNIT_COUNT && isStateChanged(state, state.activeTexture != GL_TEXTURE0 + unit)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        state.activeTexture = GL_TEXTURE0 + unit;
+    }
+
+    bindTexture(state, unit, target, texture);
+}
+
+void bindFramebuffer(GlState &state, GLenum target, GLuint framebuffer) {
+    bool isDraw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    bool isRead = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+
+    if (isStateChanged(state, (isDraw && state.drawFramebuffer != framebuffer) || (isRead && state.readFramebuffer != framebuffer))) {
+        glBindFramebuffer(target, framebuffer);
+
+        if (isDraw) {
+            state.drawFramebuffer = framebuffer;
+        }
+
+        if (isRead) {
+            state.readFramebuffer = framebuffer;
+        }
+    }
+}
+
+void setCapability(GlState &state, GLenum capability, bool isEnabled) {
+    int slot = getCapabilitySlot(capability);
+
+    if (slot != -1 && !isStateChanged(state, state.capabilities[slot] != (int) isEnabled)) {
+        return;
+    }
+
+    if (isEnabled) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+
+    if (slot != -1) {
+        state.capabilities[slot] = isEnabled;
+    } else {
+        state.issuedCount++;
+    }
+}
+
+void setDepthFunc(GlState &state, GLenum function) {
+    if (isStateChanged(state, state.depthFunc != function)) {
+        glDepthFunc(function);
+        state.depthFunc = function;
+    }
+}
+
+void setDepthMask(GlState &state, bool isEnabled) {
+    if (isStateChanged(state, state.depthMask != (int) isEnabled)) {
+        glDepthMask(isEnabled ? GL_TRUE : GL_FALSE);
+        state.depthMask = isEnabled;
+    }
+}
+
+void setColorMask(GlState &state, bool isEnabled) {
+    if (isStateChanged(state, state.colorMask != (int) isEnabled)) {
+        GLboolean mask = isEnabled ? GL_TRUE : GL_FALSE;
+        glColorMask(mask, mask, mask, mask);
+        state.colorMask = isEnabled;
+    }
+}
+
+void setBlendFunc(GlState &state, GLenum source, GLenum destination) {
+    if (isStateChanged(state, state.blendSource != source || state.blendDestination != destination)) {
+        glBlendFunc(source, destination);
+        state.blendSource = source;
+        state.blendDestination = destination;
+    }
+}
+
+void setViewport(GlState &state, const glm::ivec4 &viewport) {
+    if (isStateChanged(state, state.viewport != viewport)) {
+        glViewport(viewport.x, viewport.y, viewport.z, viewport.w);
+        state.viewport = viewport;
+    }
+}
+
+void setClearColor(GlState &state, const glm::vec4 &clearColor) {
+    if (isStateChanged(state, state.clearColor != clearColor)) {
+        glClearColor(clearColor.x, clearColor.y, clearColor.z, clearColor.w);
+        state.clearColor = clearColor;
+    }
+}
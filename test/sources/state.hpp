@@ -0,0 +1,73 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/vec4.hpp>
+
+const GLuint UNKNOWN_STATE = 0xFFFFFFFF;
+
+const int STATE_BUFFER_TARGET_COUNT = 8;
+
+const int STATE_BUFFER_BINDING_COUNT = 8;
+
+const int STATE_TEXTURE_UNIT_COUNT = 16;
+
+const int STATE_CAPABILITY_COUNT = 5;
+
+struct BufferRange {
+    GLuint buffer = UNKNOWN_STATE;
+    GLintptr offset = 0;
+    GLsizeiptr size = 0;
+};
+
+struct GlState {
+    GLuint program = UNKNOWN_STATE;
+    GLuint vertexArray = UNKNOWN_STATE;
+    GLuint drawFramebuffer = UNKNOWN_STATE;
+    GLuint readFramebuffer = UNKNOWN_STATE;
+    GLuint buffers[STATE_BUFFER_TARGET_COUNT];
+    BufferRange uniformBuffers[STATE_BUFFER_BINDING_COUNT];
+    GLenum activeTexture = UNKNOWN_STATE;
+    GLuint textures[STATE_TEXTURE_UNIT_COUNT];
+    GLenum textureTargets[STATE_TEXTURE_UNIT_COUNT];
+    int capabilities[STATE_CAPABILITY_COUNT];
+    GLenum depthFunc = UNKNOWN_STATE;
+    int depthMask = -1;
+    int colorMask = -1;
+    GLenum blendSource = UNKNOWN_STATE;
+    GLenum blendDestination = UNKNOWN_STATE;
+    glm::ivec4 viewport = glm::ivec4(-1);
+    glm::vec4 clearColor = glm::vec4(-1.0f);
+    int issuedCount = 0;
+    int elidedCount = 0;
+};
+
+void invalidateState(GlState &state);
+
+void resetStateCounters(GlState &state);
+
+void useProgram(GlState &state, GLuint program);
+
+void bindVertexArray(GlState &state, GLuint vertexArray);
+
+void bindBuffer(GlState &state, GLenum target, GLuint buffer);
+
+void bindBufferRange(GlState &state, GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+void bindTexture(GlState &state, GLuint unit, GLenum target, GLuint texture);
+
+void bindTextureForEdit(GlState &state, GLuint unit, GLenum target, GLuint texture);
+
+void bindFramebuffer(GlState &state, GLenum target, GLuint framebuffer);
+
+void setCapability(GlState &state, GLenum capability, bool isEnabled);
+
+void setDepthFunc(GlState &state, GLenum function);
+
+void setDepthMask(GlState &state, bool isEnabled);
+
+void setColorMask(GlState &state, bool isEnabled);
+
+void setBlendFunc(GlState &state, GLenum source, GLenum destination);
+
+void setViewport(GlState &state, const glm::ivec4 &viewport);
+
+void setClearColor(GlState &state, const glm::vec4 &clearColor);
@@ -0,0 +1,265 @@
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include "streaming.hpp"
+
+GLsizeiptr getLevelSize(const TexturePage &page, int level) {
+    return (GLsizeiptr) std::max(page.width >> level, 1) * std::max(page.height >> level, 1) * 4 * TEXTURE_PAGE_LAYERS;
+}
+
+void uploadPageLayer(const TexturePage &page, int layer, int level) {
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, std::max(page.width >> level, 1), std::max(page.height >> level, 1), 1, GL_RGBA, GL_UNSIGNED_BYTE, page.layers[layer][level].data());
+}
+
+GLsizeiptr getResidentSize(const TexturePage &page) {
+    GLsizeiptr size = 0;
+
+    for (int level = page.residentLevel; level < page.levelCount; ++level) {
+        size += getLevelSize(page, level);
+    }
+
+    return size;
+}
+
+void uploadLevel(Resources &resources, GlState &state, TexturePage &page, int level) {
+    bindTextureForEdit(state, 0, GL_TEXTURE_2D_ARRAY, getResource(resources, page.texture));
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, std::max(page.width >> level, 1), std::max(page.height >> level, 1), TEXTURE_PAGE_LAYERS, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    for (int layer = 0; layer < (int) page.layers.size(); ++layer) {
+        uploadPageLayer(page, layer, level);
+    }
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, level);
+    page.residentLevel = level;
+    setResourceSize(resources, page.texture, getResidentSize(page));
+}
+
+void evictLevel(Resources &resources, GlState &state, TexturePage &page) {
+    // Base level moves first so the texture is never incomplete, then the zero-size image releases the storage
+    int level = page.residentLevel;
+    bindTextureForEdit(state, 0, GL_TEXTURE_2D_ARRAY, getResource(resources, page.texture));
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, level + 1);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, 0, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    page.residentLevel = level + 1;
+    setResourceSize(resources, page.texture, getResidentSize(page));
+}
+
+std::vector<std::vector<unsigned char>> buildLevels(const unsigned char* pixels, int width, int height) {
+    std::vector<std::vector<unsigned char>> levels;
+    levels.push_back(std::vector<unsigned char>(pixels, pixels + width * height * 4));
+
+    // Box filtered chain down to 1x1, odd sizes clamp to the last row and column
+    while (std::max(width, height) > 1) {
+        const std::vector<unsigned char> &source = levels.back();
+        int levelWidth = std::max(width >> 1, 1);
+        int levelHeight = std::max(height >> 1, 1);
+        std::vector<unsigned char> level(levelWidth * levelHeight * 4);
+
+        for (int y = 0; y < levelHeight; ++y) {
+            for (int x = 0; x < levelWidth; ++x) {
+                int x0 = std::min(x * 2, width - 1);
+                int x1 = std::min(x * 2 + 1, width - 1);
+                int y0 = std::min(y * 2, height - 1);
+                int y1 = std::min(y * 2 + 1, height - 1);
+
+                for (int c = 0; c < 4; ++c) {
+                    int sum = source[(y0 * width + x0) * 4 + c] + source[(y0 * width + x1) * 4 + c] + source[(y1 * width + x0) * 4 + c] + source[(y1 * width + x1) * 4 + c];
+                    level[(y * levelWidth + x) * 4 + c] = (unsigned char) ((sum + 2) / 4);
+                }
+            }
+        }
+
+        levels.push_back(level);
+        width = levelWidth;
+        height = levelHeight;
+    }
+
+    return levels;
+}
+
+int createPage(TextureStreaming &streaming, Resources &resources, int width, int height) {
+    TexturePage page;
+    page.width = width;
+    page.height = height;
+    page.levelCount = 1;
+
+    while (std::max(width >> page.levelCount, height >> page.levelCount) > 0) {
+        page.levelCount++;
+    }
+
+    while (std::max(width >> page.tailLevel, height >> page.tailLevel) > STREAMING_TAIL_SIZE) {
+        page.tailLevel++;
+    }
+
+    page.lastNeeded.assign(page.levelCount, 0);
+    page.residentLevel = page.tailLevel;
+    page.requestedLevel = page.tailLevel;
+
+    // Only the small tail is resident up front, it's cheap enough to never be evicted
+    page.texture = createResource(resources, ResourceType::Texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, getResource(resources, page.texture));
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, page.tailLevel);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, page.levelCount - 1);
+
+    for (int level = page.tailLevel; level < page.levelCount; ++level) {
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, std::max(width >> level, 1), std::max(height >> level, 1), TEXTURE_PAGE_LAYERS, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        streaming.residentSize += getLevelSize(page, level);
+    }
+
+    setResourceSize(resources, page.texture, getResidentSize(page));
+    streaming.pages.push_back(page);
+
+    return (int) streaming.pages.size() - 1;
+}
+
+TextureHandle loadStreamedTexture(TextureStreaming &streaming, Resources &resources, Uploads &uploads, const unsigned char* data, int size) {
+    TextureHandle handle;
+    int width, height, channels;
+    unsigned char* pixels = stbi_load_from_memory(data, size, &width, &height, &channels, 4);
+
+    if (!pixels) {
+        std::cout << "Failed to decode texture: " << stbi_failure_reason() << std::endl;
+
+        return handle;
+    }
+
+    std::vector<std::vector<unsigned char>> levels = buildLevels(pixels, width, height);
+    stbi_image_free(pixels);
+
+    GLint lastTexture;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &lastTexture);
+
+    for (int a = 0; a < (int) streaming.pages.size(); ++a) {
+        const TexturePage &page = streaming.pages[a];
+
+        if (page.width == width && page.height == height && page.layers.size() < TEXTURE_PAGE_LAYERS) {
+            handle.page = a;
+
+            break;
+        }
+    }
+
+    if (handle.page == -1) {
+        handle.page = createPage(streaming, resources, width, height);
+    }
+
+    TexturePage &page = streaming.pages[handle.page];
+    handle.layer = (int) page.layers.size();
+    page.layers.push_back(levels);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, getResource(resources, page.texture));
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // The tail is never evicted, so it can wait in the upload queue. Streamed levels above it go up now
+    for (int level = page.residentLevel; level < page.levelCount; ++level) {
+        if (level < page.tailLevel) {
+            uploadPageLayer(page, handle.layer, level);
+        } else {
+            queueTextureUpload(uploads, page.texture, level, handle.layer, std::max(width >> level, 1), std::max(height >> level, 1), page.layers[handle.layer][level].data());
+        }
+    }
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, lastTexture);
+
+    return handle;
+}
+
+int getTextureLevel(const TexturePage &page, float screenSize) {
+    if (screenSize <= 0.0f) {
+        return page.tailLevel;
+    }
+
+    int level = (int) floorf(log2f(std::max(page.width, page.height) / screenSize));
+
+    return std::min(std::max(level, 0), page.tailLevel);
+}
+
+int findEvictable(TextureStreaming &streaming) {
+    int evictable = -1;
+    uint64_t oldest = streaming.frame;
+
+    // Only a page's top resident level can go, and never one needed this frame
+    for (int a = 0; a < (int) streaming.pages.size(); ++a) {
+        TexturePage &page = streaming.pages[a];
+
+        if (page.residentLevel < page.tailLevel && page.lastNeeded[page.residentLevel] < oldest) {
+            oldest = page.lastNeeded[page.residentLevel];
+            evictable = a;
+        }
+    }
+
+    return evictable;
+}
+
+void updateTextureStreaming(TextureStreaming &streaming, Resources &resources, GlState &state, const std::vector<int> &requests, GLsizeiptr budget) {
+    streaming.frame++;
+
+    for (int a = 0; a < (int) streaming.pages.size(); ++a) {
+        TexturePage &page = streaming.pages[a];
+        page.requestedLevel = a < (int) requests.size() ? std::min(requests[a], page.tailLevel) : page.tailLevel;
+
+        for (int level = page.requestedLevel; level < page.tailLevel; ++level) {
+            page.lastNeeded[level] = streaming.frame;
+        }
+    }
+
+    while (streaming.residentSize > budget) {
+        int evictable = findEvictable(streaming);
+
+        if (evictable == -1) {
+            break;
+        }
+
+        TexturePage &page = streaming.pages[evictable];
+        streaming.residentSize -= getLevelSize(page, page.residentLevel);
+        evictLevel(resources, state, page);
+    }
+
+    // One level per page per frame keeps uploads bounded and sharpens progressively
+    GLsizeiptr uploadedSize = 0;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (auto &page : streaming.pages) {
+        if (page.residentLevel <= page.requestedLevel) {
+            continue;
+        }
+
+        int level = page.residentLevel - 1;
+        GLsizeiptr size = getLevelSize(page, level);
+
+        if (uploadedSize > 0 && uploadedSize + size > streaming.uploadLimit) {
+            break;
+        }
+
+        while (streaming.residentSize + size > budget) {
+            int evictable = findEvictable(streaming);
+
+            if (evictable == -1) {
+                break;
+            }
+
+            TexturePage &victim = streaming.pages[evictable];
+            streaming.residentSize -= getLevelSize(victim, victim.residentLevel);
+            evictLevel(resources, state, victim);
+        }
+
+        if (streaming.residentSize + size > budget) {
+            continue;
+        }
+
+        uploadLevel(resources, state, page, level);
+        streaming.residentSize += size;
+        uploadedSize += size;
+    }
+}
+
+void destroyTextureStreaming(TextureStreaming &streaming, Resources &resources) {
+    for (auto &page : streaming.pages) {
+        releaseResource(resources, page.texture);
+    }
+
+    streaming.pages.clear();
+    streaming.residentSize = 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "state.hpp"
+#include "resources.hpp"
+#include "uploads.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+
+const int STREAMING_TAIL_SIZE = 64;
+const int TEXTURE_PAGE_LAYERS = 16;
+
+struct TextureHandle {
+    int page = -1;
+    int layer = 0;
+};
+
+// Same-sized textures share one array page, so residency is tracked per page. Decoded levels stay in system memory
+struct TexturePage {
+    ResourceHandle texture;
+    int width = 0;
+    int height = 0;
+    int levelCount = 0;
+    int tailLevel = 0;
+    int residentLevel = 0;
+    int requestedLevel = 0;
+    std::vector<std::vector<std::vector<unsigned char>>> layers;
+    std::vector<uint64_t> lastNeeded;
+};
+
+struct TextureStreaming {
+    std::vector<TexturePage> pages;
+    GLsizeiptr budget = 256 << 20;
+    GLsizeiptr uploadLimit = 8 << 20;
+    GLsizeiptr residentSize = 0;
+    uint64_t frame = 0;
+};
+
+GLsizeiptr getLevelSize(const TexturePage &page, int level);
+
+TextureHandle loadStreamedTexture(TextureStreaming &streaming, Resources &resources, Uploads &uploads, const unsigned char* data, int size);
+
+int getTextureLevel(const TexturePage &page, float screenSize);
+
+void updateTextureStreaming(TextureStreaming &streaming, Resources &resources, GlState &state, const std::vector<int> &requests, GLsizeiptr budget);
+
+void destroyTextureStreaming(TextureStreaming &streaming, Resources &resources);
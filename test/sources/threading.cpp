@@ -0,0 +1,144 @@
+#include "threading.hpp"
+
+void captureGui(GuiSnapshot &snapshot, const ImDrawData* drawData) {
+    releaseGui(snapshot);
+
+    if (!drawData) {
+        return;
+    }
+
+    // Draw lists are reused by ImGui on the next NewFrame, so the render thread gets its own copies
+    snapshot.drawData = *drawData;
+    snapshot.drawLists.reserve(drawData->CmdListsCount);
+
+    for (int a = 0; a < drawData->CmdListsCount; ++a) {
+        snapshot.drawLists.push_back(drawData->CmdLists[a]->CloneOutput());
+    }
+
+    snapshot.drawData.CmdLists = snapshot.drawLists.data();
+}
+
+void releaseGui(GuiSnapshot &snapshot) {
+    for (auto drawList : snapshot.drawLists) {
+        IM_DELETE(drawList);
+    }
+
+    snapshot.drawLists.clear();
+    snapshot.drawData = ImDrawData();
+}
+
+void presentFrame(SDL_Window* window, Renderer &renderer, Frame &frame, GuiSnapshot* gui) {
+    beginProfilerFrame(renderer.profiler);
+    int frameScope = beginGpuScope(renderer.profiler, "Frame");
+
+    // In panel mode the scene only covers the viewport window, ImGui then draws it as an image over the cleared window
+    if (frame.isViewportPanel && resizeRenderTarget(renderer.viewportTarget, renderer.resources, frame.viewport) == 0) {
+        renderer.outputFramebuffer = getResource(renderer.resources, renderer.viewportTarget.framebuffer);
+        renderFrame(renderer, frame);
+        frame.stats.viewportTexture = getResource(renderer.resources, renderer.viewportTarget.colorTexture);
+        bindFramebuffer(renderer.state, GL_FRAMEBUFFER, 0);
+        setViewport(renderer.state, glm::ivec4(0, 0, frame.windowSize.x, frame.windowSize.y));
+        glClear(GL_COLOR_BUFFER_BIT);
+    } else {
+        renderer.outputFramebuffer = 0;
+        renderFrame(renderer, frame);
+    }
+
+    int guiScope = beginGpuScope(renderer.profiler, "ImGui");
+    ImGui_ImplOpenGL3_RenderDrawData(gui ? &gui->drawData : ImGui::GetDrawData());
+    endGpuScope(renderer.profiler, guiScope);
+    endGpuScope(renderer.profiler, frameScope);
+    frame.stats.timings = getGpuTimings(renderer.profiler);
+
+    // Swap interval belongs to whichever thread has the context current, adaptive falls back to plain vsync where unsupported
+    if (frame.swapInterval != renderer.appliedSwapInterval) {
+        if (SDL_GL_SetSwapInterval(frame.swapInterval) != 0 && frame.swapInterval == -1) {
+            SDL_GL_SetSwapInterval(1);
+        }
+
+        renderer.appliedSwapInterval = frame.swapInterval;
+    }
+
+    SDL_GL_SwapWindow(window);
+}
+
+void runRenderThread(RenderThread &renderThread, Renderer &renderer) {
+    SDL_GL_MakeCurrent(renderThread.window, renderThread.context);
+
+    while (true) {
+        int index;
+
+        {
+            std::unique_lock<std::mutex> lock(renderThread.mutex);
+            renderThread.condition.wait(lock, [&renderThread] { return renderThread.isFramePending || !renderThread.isActive; });
+
+            if (!renderThread.isFramePending) {
+                break;
+            }
+
+            index = renderThread.pendingIndex;
+            renderThread.isFramePending = false;
+            renderThread.isRendering = true;
+        }
+
+        presentFrame(renderThread.window, renderer, renderThread.frames[index], &renderThread.guis[index]);
+
+        {
+            std::lock_guard<std::mutex> lock(renderThread.mutex);
+            renderThread.isRendering = false;
+        }
+
+        renderThread.condition.notify_all();
+    }
+
+    SDL_GL_MakeCurrent(renderThread.window, nullptr);
+}
+
+void startRenderThread(RenderThread &renderThread, SDL_Window* window, SDL_GLContext context, Renderer &renderer) {
+    renderThread.window = window;
+    renderThread.context = context;
+    renderThread.isActive = true;
+
+    // Context can only be current on one thread at a time
+    SDL_GL_MakeCurrent(window, nullptr);
+    renderThread.thread = std::thread(runRenderThread, std::ref(renderThread), std::ref(renderer));
+}
+
+void stopRenderThread(RenderThread &renderThread) {
+    {
+        std::lock_guard<std::mutex> lock(renderThread.mutex);
+        renderThread.isActive = false;
+    }
+
+    renderThread.condition.notify_all();
+    renderThread.thread.join();
+
+    for (auto &gui : renderThread.guis) {
+        releaseGui(gui);
+    }
+
+    SDL_GL_MakeCurrent(renderThread.window, renderThread.context);
+}
+
+Frame &getWriteFrame(RenderThread &renderThread) {
+    return renderThread.frames[renderThread.writeIndex];
+}
+
+GuiSnapshot &getWriteGui(RenderThread &renderThread) {
+    return renderThread.guis[renderThread.writeIndex];
+}
+
+void submitFrame(RenderThread &renderThread, Renderer &renderer) {
+    {
+        // Previous frame has to be fully rendered before its buffer is handed back for writing
+        std::unique_lock<std::mutex> lock(renderThread.mutex);
+        renderThread.condition.wait(lock, [&renderThread] { return !renderThread.isFramePending && !renderThread.isRendering; });
+
+        renderThread.pendingIndex = renderThread.writeIndex;
+        renderThread.writeIndex = 1 - renderThread.writeIndex;
+        renderThread.isFramePending = true;
+        renderer.stats = renderThread.frames[renderThread.writeIndex].stats;
+    }
+
+    renderThread.condition.notify_all();
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "renderer.hpp"
+#include <imgui/imgui.h>
+#include <imgui/backends/imgui_impl_opengl3.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct GuiSnapshot {
+    ImDrawData drawData;
+    std::vector<ImDrawList*> drawLists;
+};
+
+struct RenderThread {
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    SDL_Window* window = nullptr;
+    SDL_GLContext context = nullptr;
+    Frame frames[2];
+    GuiSnapshot guis[2];
+    int writeIndex = 0;
+    int pendingIndex = 0;
+    bool isFramePending = false;
+    bool isRendering = false;
+    bool isActive = false;
+};
+
+void captureGui(GuiSnapshot &snapshot, const ImDrawData* drawData);
+
+void releaseGui(GuiSnapshot &snapshot);
+
+void presentFrame(SDL_Window* window, Renderer &renderer, Frame &frame, GuiSnapshot* gui);
+
+void startRenderThread(RenderThread &renderThread, SDL_Window* window, SDL_GLContext context, Renderer &renderer);
+
+void stopRenderThread(RenderThread &renderThread);
+
+Frame &getWriteFrame(RenderThread &renderThread);
+
+GuiSnapshot &getWriteGui(RenderThread &renderThread);
+
+void submitFrame(RenderThread &renderThread, Renderer &renderer);
@@ -0,0 +1,133 @@
+#include "renderer.hpp"
+
+int allocateTransformSlot(TransformSlots &slots, const glm::mat4 &matrix) {
+    int slot = slots.count;
+
+    if (!slots.freeSlots.empty()) {
+        slot = slots.freeSlots.back();
+        slots.freeSlots.pop_back();
+    } else {
+        slots.count++;
+    }
+
+    setTransform(slots, slot, matrix);
+
+    return slot;
+}
+
+void setTransform(TransformSlots &slots, int slot, const glm::mat4 &matrix) {
+    slots.updates.push_back({ slot, matrix });
+}
+
+void releaseTransformSlot(TransformSlots &slots, entt::registry &registry, entt::entity entity) {
+    slots.freeSlots.push_back(registry.get<TransformSlot>(entity).slot);
+}
+
+glm::mat4 getTransformMatrix(const Transform &transform) {
+    glm::mat4 matrix = glm::translate(glm::mat4(1.0f), transform.translation);
+    matrix = glm::rotate(matrix, transform.rotation.y, glm::vec3(0.0f, 1.0f, 0.0f));
+    matrix = glm::rotate(matrix, transform.rotation.x, glm::vec3(1.0f, 0.0f, 0.0f));
+    matrix = glm::rotate(matrix, transform.rotation.z, glm::vec3(0.0f, 0.0f, 1.0f));
+
+    return glm::scale(matrix, transform.scale);
+}
+
+void syncTransforms(Renderer &renderer, entt::registry &registry, entt::observer &observer) {
+    // Only entities created or patched since the last sync get a new matrix, everything else is already on the GPU
+    for (auto entity : observer) {
+        Transform &transform = registry.get<Transform>(entity);
+        transform.matrix = getTransformMatrix(transform);
+
+        if (registry.all_of<TransformSlot>(entity)) {
+            setTransform(renderer.transformSlots, registry.get<TransformSlot>(entity).slot, transform.matrix);
+        } else {
+            registry.emplace<TransformSlot>(entity, allocateTransformSlot(renderer.transformSlots, transform.matrix));
+        }
+    }
+
+    observer.clear();
+    renderer.entityInstances.clear();
+
+    // MeshReference indexes into the loaded models
+    registry.view<Transform, TransformSlot, MeshReference>().each([&renderer](auto entity, Transform &transform, TransformSlot &slot, MeshReference &mesh) {
+        if (mesh.meshIndex >= 0 && mesh.meshIndex < (int) renderer.models.size()) {
+            renderer.entityInstances.push_back({ mesh.meshIndex, transform.matrix, slot.slot });
+        }
+    });
+}
+
+void createTransformBuffer(TransformBuffer &buffer, Resources &resources) {
+    buffer.buffer = createResource(resources, ResourceType::Buffer);
+    buffer.texture = createResource(resources, ResourceType::Texture);
+    setResourceSize(resources, buffer.buffer, sizeof(glm::mat4));
+    glBindBuffer(GL_TEXTURE_BUFFER, getResource(resources, buffer.buffer));
+    glBufferData(GL_TEXTURE_BUFFER, sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
+    glBindTexture(GL_TEXTURE_BUFFER, getResource(resources, buffer.texture));
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, getResource(resources, buffer.buffer));
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    buffer.capacity = 1;
+}
+
+void destroyTransformBuffer(TransformBuffer &buffer, Resources &resources) {
+    releaseResource(resources, buffer.buffer);
+    releaseResource(resources, buffer.texture);
+    buffer.capacity = 0;
+}
+
+void bindTransformSampler(GLuint program) {
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "u_Transforms"), TRANSFORM_TEXTURE_UNIT);
+    glUseProgram(0);
+}
+
+void growTransformBuffer(TransformBuffer &buffer, Resources &resources, GlState &state, int slotCount) {
+    int capacity = std::max(slotCount, buffer.capacity * 2);
+    ResourceHandle grown = createResource(resources, ResourceType::Buffer);
+    setResourceSize(resources, grown, capacity * sizeof(glm::mat4));
+    bindBuffer(state, GL_COPY_WRITE_BUFFER, getResource(resources, grown));
+    glBufferData(GL_COPY_WRITE_BUFFER, capacity * sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
+
+    // Existing rows are copied on the GPU, the CPU never keeps a full mirror. The old buffer goes once the copy has run
+    bindBuffer(state, GL_COPY_READ_BUFFER, getResource(resources, buffer.buffer));
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, buffer.capacity * sizeof(glm::mat4));
+    releaseResource(resources, buffer.buffer);
+
+    buffer.buffer = grown;
+    buffer.capacity = capacity;
+    bindTextureForEdit(state, TRANSFORM_TEXTURE_UNIT, GL_TEXTURE_BUFFER, getResource(resources, buffer.texture));
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, getResource(resources, buffer.buffer));
+}
+
+void uploadTransforms(TransformBuffer &buffer, Resources &resources, GlState &state, std::vector<TransformUpdate> &updates, int slotCount) {
+    if (slotCount > buffer.capacity) {
+        growTransformBuffer(buffer, resources, state, slotCount);
+    }
+
+    buffer.uploadedSize = 0;
+    bindBuffer(state, GL_TEXTURE_BUFFER, getResource(resources, buffer.buffer));
+
+    // Sorted by slot so neighbouring rows go up in one call, the latest write to a slot wins
+    std::stable_sort(updates.begin(), updates.end(), [](const TransformUpdate &a, const TransformUpdate &b) {
+        return a.slot < b.slot;
+    });
+
+    for (size_t a = 0; a < updates.size();) {
+        int first = updates[a].slot;
+        buffer.scratch.clear();
+
+        for (; a < updates.size() && updates[a].slot <= first + (int) buffer.scratch.size(); ++a) {
+            if (updates[a].slot == first + (int) buffer.scratch.size()) {
+                buffer.scratch.push_back(updates[a].matrix);
+            } else {
+                buffer.scratch.back() = updates[a].matrix;
+            }
+        }
+
+        GLsizeiptr size = buffer.scratch.size() * sizeof(glm::mat4);
+        glBufferSubData(GL_TEXTURE_BUFFER, first * sizeof(glm::mat4), size, buffer.scratch.data());
+        buffer.uploadedSize += size;
+    }
+
+    bindTexture(state, TRANSFORM_TEXTURE_UNIT, GL_TEXTURE_BUFFER, getResource(resources, buffer.texture));
+}
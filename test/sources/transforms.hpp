@@ -0,0 +1,54 @@
+#pragma once
+#include "state.hpp"
+#include "resources.hpp"
+#include <algorithm>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/mat4x4.hpp>
+#include <entt/entt.hpp>
+
+const GLuint TRANSFORM_TEXTURE_UNIT = 4;
+
+struct Renderer;
+
+// Component linking an entity to its row in the transform buffer
+struct TransformSlot {
+    int slot = -1;
+};
+
+struct TransformUpdate {
+    int slot;
+    glm::mat4 matrix;
+};
+
+// Main thread side, hands out slots and collects changed matrices until the next frame takes them
+struct TransformSlots {
+    int count = 0;
+    std::vector<int> freeSlots;
+    std::vector<TransformUpdate> updates;
+};
+
+// Render thread side, one mat4 per slot that persists across frames
+struct TransformBuffer {
+    ResourceHandle buffer;
+    ResourceHandle texture;
+    int capacity = 0;
+    std::vector<glm::mat4> scratch;
+    GLsizeiptr uploadedSize = 0;
+};
+
+int allocateTransformSlot(TransformSlots &slots, const glm::mat4 &matrix);
+
+void setTransform(TransformSlots &slots, int slot, const glm::mat4 &matrix);
+
+void releaseTransformSlot(TransformSlots &slots, entt::registry &registry, entt::entity entity);
+
+void syncTransforms(Renderer &renderer, entt::registry &registry, entt::observer &observer);
+
+void createTransformBuffer(TransformBuffer &buffer, Resources &resources);
+
+void destroyTransformBuffer(TransformBuffer &buffer, Resources &resources);
+
+void bindTransformSampler(GLuint program);
+
+void uploadTransforms(TransformBuffer &buffer, Resources &resources, GlState &state, std::vector<TransformUpdate> &updates, int slotCount);
@@ -0,0 +1,149 @@
+#include "uniforms.hpp"
+
+GLsizeiptr alignUniformSize(const UniformRing &ring, GLsizeiptr size) {
+    return (size + ring.alignment - 1) / ring.alignment * ring.alignment;
+}
+
+GLintptr getUniformFrameStart(const UniformRing &ring) {
+    return ring.frame * ring.frameSize;
+}
+
+void createUniformBuffer(UniformRing &ring, Resources &resources) {
+    ring.buffer = createResource(resources, ResourceType::Buffer);
+    setResourceSize(resources, ring.buffer, ring.frameSize * UNIFORM_FRAME_COUNT);
+    glBindBuffer(GL_UNIFORM_BUFFER, getResource(resources, ring.buffer));
+
+    if (ring.isPersistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_UNIFORM_BUFFER, ring.frameSize * UNIFORM_FRAME_COUNT, nullptr, flags);
+        ring.mapped = (char*) glMapBufferRange(GL_UNIFORM_BUFFER, 0, ring.frameSize * UNIFORM_FRAME_COUNT, flags);
+
+        if (ring.mapped) {
+            return;
+        }
+
+        // Storage is immutable, so falling back to per-frame mapping needs a fresh buffer
+        std::cout << "Failed to persistently map uniform buffer, mapping per frame instead" << std::endl;
+        ring.isPersistent = false;
+        releaseResource(resources, ring.buffer);
+        ring.buffer = createResource(resources, ResourceType::Buffer);
+        setResourceSize(resources, ring.buffer, ring.frameSize * UNIFORM_FRAME_COUNT);
+        glBindBuffer(GL_UNIFORM_BUFFER, getResource(resources, ring.buffer));
+    }
+
+    glBufferData(GL_UNIFORM_BUFFER, ring.frameSize * UNIFORM_FRAME_COUNT, nullptr, GL_STREAM_DRAW);
+}
+
+void createUniformRing(UniformRing &ring, Resources &resources, GLsizeiptr frameSize) {
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &ring.alignment);
+    ring.frameSize = alignUniformSize(ring, frameSize);
+    ring.isPersistent = GLAD_GL_ARB_buffer_storage;
+    createUniformBuffer(ring, resources);
+}
+
+void destroyUniformRing(UniformRing &ring, Resources &resources) {
+    for (auto &fence : ring.fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    if (ring.mapped) {
+        glBindBuffer(GL_UNIFORM_BUFFER, getResource(resources, ring.buffer));
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+        ring.mapped = nullptr;
+    }
+
+    releaseResource(resources, ring.buffer);
+}
+
+void growUniformRing(UniformRing &ring, Resources &resources, GLsizeiptr frameSize) {
+    // Release waits on its own fence, so draws still in flight keep reading the old buffer while the new one fills
+    destroyUniformRing(ring, resources);
+    ring.frameSize = alignUniformSize(ring, std::max(frameSize, ring.frameSize * 2));
+    createUniformBuffer(ring, resources);
+}
+
+void beginUniformFrame(UniformRing &ring, Resources &resources, GLsizeiptr size) {
+    if (size > ring.frameSize) {
+        growUniformRing(ring, resources, size);
+    }
+
+    GLsync &fence = ring.fences[ring.frame];
+
+    // The segment written now was last used three frames ago, so this only blocks when the GPU falls that far behind
+    if (fence) {
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED);
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    ring.offset = 0;
+    ring.failedCount = 0;
+
+    if (ring.isPersistent) {
+        ring.data = ring.mapped + getUniformFrameStart(ring);
+    } else {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
+        glBindBuffer(GL_UNIFORM_BUFFER, getResource(resources, ring.buffer));
+        ring.data = (char*) glMapBufferRange(GL_UNIFORM_BUFFER, getUniformFrameStart(ring), ring.frameSize, flags);
+    }
+}
+
+UniformAllocation allocateUniforms(UniformRing &ring, GLsizeiptr size) {
+    UniformAllocation allocation;
+    GLsizeiptr alignedSize = alignUniformSize(ring, size);
+
+    if (!ring.data || ring.offset + alignedSize > ring.frameSize) {
+        // Once per frame is enough, the rest of the frame's allocations fail the same way
+        if (ring.failedCount++ == 0) {
+            std::cout << "Uniform ring is out of space" << std::endl;
+        }
+
+        return allocation;
+    }
+
+    allocation.offset = getUniformFrameStart(ring) + ring.offset;
+    allocation.data = ring.data + ring.offset;
+    ring.offset += alignedSize;
+
+    return allocation;
+}
+
+GLintptr writeUniforms(UniformRing &ring, const void* data, GLsizeiptr size) {
+    UniformAllocation allocation = allocateUniforms(ring, size);
+
+    if (allocation.data) {
+        memcpy(allocation.data, data, size);
+    }
+
+    return allocation.offset;
+}
+
+void flushUniformFrame(UniformRing &ring, const Resources &resources) {
+    ring.usedSize = ring.offset;
+
+    // Non-persistent mappings have to be released before any draw reads from the buffer
+    if (!ring.isPersistent && ring.data) {
+        glBindBuffer(GL_UNIFORM_BUFFER, getResource(resources, ring.buffer));
+        glFlushMappedBufferRange(GL_UNIFORM_BUFFER, 0, ring.offset);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+    }
+
+    ring.data = nullptr;
+}
+
+void endUniformFrame(UniformRing &ring) {
+    ring.fences[ring.frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ring.frame = (ring.frame + 1) % UNIFORM_FRAME_COUNT;
+}
+
+void bindUniformBlock(GLuint program, const char* name, GLuint binding) {
+    GLuint index = glGetUniformBlockIndex(program, name);
+
+    if (index != GL_INVALID_INDEX) {
+        glUniformBlockBinding(program, index, binding);
+    }
+}
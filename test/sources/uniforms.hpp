@@ -0,0 +1,45 @@
+#pragma once
+#include "resources.hpp"
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <glad/glad.h>
+
+const int UNIFORM_FRAME_COUNT = 3;
+
+struct UniformAllocation {
+    GLintptr offset = -1;
+    char* data = nullptr;
+};
+
+struct UniformRing {
+    ResourceHandle buffer;
+    GLsizeiptr frameSize = 0;
+    GLint alignment = 256;
+    bool isPersistent = false;
+    char* mapped = nullptr;
+    char* data = nullptr;
+    GLsync fences[UNIFORM_FRAME_COUNT] = {};
+    int frame = 0;
+    GLsizeiptr offset = 0;
+    GLsizeiptr usedSize = 0;
+    int failedCount = 0;
+};
+
+GLsizeiptr alignUniformSize(const UniformRing &ring, GLsizeiptr size);
+
+void createUniformRing(UniformRing &ring, Resources &resources, GLsizeiptr frameSize);
+
+void destroyUniformRing(UniformRing &ring, Resources &resources);
+
+void beginUniformFrame(UniformRing &ring, Resources &resources, GLsizeiptr size);
+
+UniformAllocation allocateUniforms(UniformRing &ring, GLsizeiptr size);
+
+GLintptr writeUniforms(UniformRing &ring, const void* data, GLsizeiptr size);
+
+void flushUniformFrame(UniformRing &ring, const Resources &resources);
+
+void endUniformFrame(UniformRing &ring);
+
+void bindUniformBlock(GLuint program, const char* name, GLuint binding);
@@ -0,0 +1,249 @@
+#include "uploads.hpp"
+
+GLsizeiptr alignUploadSize(GLsizeiptr size) {
+    return (size + UPLOAD_ALIGNMENT - 1) / UPLOAD_ALIGNMENT * UPLOAD_ALIGNMENT;
+}
+
+void createUploads(Uploads &uploads, Resources &resources, GLsizeiptr stagingSize) {
+    uploads.stagingSize = alignUploadSize(stagingSize);
+    uploads.isPersistent = GLAD_GL_ARB_buffer_storage;
+
+    uploads.staging = createResource(resources, ResourceType::Buffer);
+    setResourceSize(resources, uploads.staging, uploads.stagingSize);
+    glBindBuffer(GL_COPY_READ_BUFFER, getResource(resources, uploads.staging));
+
+    if (uploads.isPersistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_READ_BUFFER, uploads.stagingSize, nullptr, flags);
+        uploads.mapped = (char*) glMapBufferRange(GL_COPY_READ_BUFFER, 0, uploads.stagingSize, flags);
+
+        if (!uploads.mapped) {
+            std::cout << "Failed to persistently map staging buffer" << std::endl;
+        }
+    } else {
+        glBufferData(GL_COPY_READ_BUFFER, uploads.stagingSize, nullptr, GL_STREAM_DRAW);
+    }
+
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+}
+
+void destroyUploads(Uploads &uploads, Resources &resources) {
+    for (auto &retirement : uploads.retirements) {
+        glDeleteSync(retirement.fence);
+    }
+
+    if (uploads.mapped) {
+        glBindBuffer(GL_COPY_READ_BUFFER, getResource(resources, uploads.staging));
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+        uploads.mapped = nullptr;
+    }
+
+    releaseResource(resources, uploads.staging);
+    uploads.retirements.clear();
+    uploads.pending.clear();
+    uploads.pendingSize = 0;
+}
+
+uint64_t queueUpload(Uploads &uploads, PendingUpload &upload, const void* data, GLsizeiptr size) {
+    // The source is copied, callers can drop or move their data right away
+    upload.data.assign((const char*) data, (const char*) data + size);
+    upload.ticket = ++uploads.queuedTicket;
+    uploads.pendingSize += size;
+    uploads.pending.push_back(std::move(upload));
+
+    return uploads.queuedTicket;
+}
+
+uint64_t queueBufferUpload(Uploads &uploads, ResourceHandle buffer, GLintptr offset, const void* data, GLsizeiptr size) {
+    PendingUpload upload;
+    upload.target = buffer;
+    upload.offset = offset;
+
+    return queueUpload(uploads, upload, data, size);
+}
+
+uint64_t queueTextureUpload(Uploads &uploads, ResourceHandle texture, int level, int layer, int width, int height, const void* data) {
+    PendingUpload upload;
+    upload.target = texture;
+    upload.isTexture = true;
+    upload.level = level;
+    upload.layer = layer;
+    upload.width = width;
+    upload.height = height;
+
+    return queueUpload(uploads, upload, data, (GLsizeiptr) width * height * 4);
+}
+
+bool isUploadIssued(const Uploads &uploads, uint64_t ticket) {
+    return ticket <= uploads.issuedTicket;
+}
+
+void reclaimStaging(Uploads &uploads) {
+    // Fences signal in submission order, so the first one still pending ends the scan
+    size_t reclaimedCount = 0;
+
+    for (; reclaimedCount < uploads.retirements.size(); ++reclaimedCount) {
+        StagingRetirement &retirement = uploads.retirements[reclaimedCount];
+        GLenum status = glClientWaitSync(retirement.fence, 0, 0);
+
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+
+        glDeleteSync(retirement.fence);
+        uploads.usedSize -= retirement.size;
+    }
+
+    uploads.retirements.erase(uploads.retirements.begin(), uploads.retirements.begin() + reclaimedCount);
+
+    if (uploads.usedSize == 0) {
+        uploads.head = 0;
+    }
+}
+
+void fenceStaging(Uploads &uploads) {
+    if (uploads.frameSize > 0) {
+        uploads.retirements.push_back({ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), uploads.frameSize });
+        uploads.frameSize = 0;
+    }
+}
+
+GLintptr reserveStaging(Uploads &uploads, GLsizeiptr minimum, GLsizeiptr &size) {
+    GLsizeiptr tail = (uploads.head - uploads.usedSize + uploads.stagingSize) % uploads.stagingSize;
+    bool isFull = uploads.usedSize == uploads.stagingSize;
+    GLsizeiptr available = isFull ? 0 : (tail > uploads.head ? tail - uploads.head : uploads.stagingSize - uploads.head);
+
+    // Too little left before the end of the ring, the rest is skipped and comes back with this frame's fence
+    if (available < minimum && !isFull && tail <= uploads.head) {
+        GLsizeiptr skipped = uploads.stagingSize - uploads.head;
+        uploads.usedSize += skipped;
+        uploads.frameSize += skipped;
+        uploads.head = 0;
+        available = tail;
+    }
+
+    if (available < minimum) {
+        return -1;
+    }
+
+    // Every reservation keeps the head aligned, so the space in front of it always is too
+    size = std::min(size, available);
+    GLintptr offset = uploads.head;
+    GLsizeiptr reserved = alignUploadSize(size);
+    uploads.head = (uploads.head + reserved) % uploads.stagingSize;
+    uploads.usedSize += reserved;
+    uploads.frameSize += reserved;
+
+    return offset;
+}
+
+void writeStaging(Uploads &uploads, Resources &resources, GlState &state, GLintptr offset, const char* data, GLsizeiptr size) {
+    if (uploads.mapped) {
+        memcpy(uploads.mapped + offset, data, size);
+
+        return;
+    }
+
+    // Unsynchronized is safe here, the fences already guarantee the GPU is done with this range
+    bindBuffer(state, GL_COPY_READ_BUFFER, getResource(resources, uploads.staging));
+    char* mapped = (char*) glMapBufferRange(GL_COPY_READ_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+
+    if (!mapped) {
+        std::cout << "Failed to map staging buffer" << std::endl;
+
+        return;
+    }
+
+    memcpy(mapped, data, size);
+    glUnmapBuffer(GL_COPY_READ_BUFFER);
+}
+
+void copyUploads(Uploads &uploads, Resources &resources, GlState &state, GLsizeiptr budget) {
+    GLuint staging = getResource(resources, uploads.staging);
+    GLsizeiptr copiedSize = 0;
+
+    while (!uploads.pending.empty() && copiedSize < budget) {
+        PendingUpload &upload = uploads.pending.front();
+        GLsizeiptr remaining = (GLsizeiptr) upload.data.size() - upload.copiedSize;
+        GLuint target = getResource(resources, upload.target);
+        GLsizeiptr size = remaining;
+
+        // Targets released before their data arrived are simply dropped
+        if (!target || remaining == 0) {
+            uploads.pendingSize -= remaining;
+            uploads.issuedTicket = upload.ticket;
+            uploads.pending.pop_front();
+
+            continue;
+        }
+
+        if (upload.isTexture) {
+            // A level that doesn't fit what is left of the budget waits, unless nothing went up yet this frame
+            if (copiedSize > 0 && remaining > budget - copiedSize) {
+                break;
+            }
+
+            GLintptr offset = remaining > uploads.stagingSize ? -1 : reserveStaging(uploads, remaining, size);
+
+            if (offset == -1 && remaining <= uploads.stagingSize) {
+                break;
+            }
+
+            // Levels larger than the whole ring go straight from client memory
+            bindTextureForEdit(state, 0, GL_TEXTURE_2D_ARRAY, target);
+            bindBuffer(state, GL_PIXEL_UNPACK_BUFFER, offset == -1 ? 0 : staging);
+
+            if (offset != -1) {
+                writeStaging(uploads, resources, state, offset, upload.data.data(), size);
+            }
+
+            const void* pixels = offset == -1 ? (const void*) upload.data.data() : (const void*) (uintptr_t) offset;
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, upload.level, 0, 0, upload.layer, upload.width, upload.height, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        } else {
+            size = std::min(remaining, budget - copiedSize);
+            GLintptr offset = reserveStaging(uploads, std::min(size, UPLOAD_ALIGNMENT), size);
+
+            if (offset == -1) {
+                break;
+            }
+
+            writeStaging(uploads, resources, state, offset, upload.data.data() + upload.copiedSize, size);
+            bindBuffer(state, GL_COPY_READ_BUFFER, staging);
+            bindBuffer(state, GL_COPY_WRITE_BUFFER, target);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offset, upload.offset + upload.copiedSize, size);
+        }
+
+        upload.copiedSize += size;
+        copiedSize += size;
+        uploads.pendingSize -= size;
+
+        if (upload.copiedSize == (GLsizeiptr) upload.data.size()) {
+            uploads.issuedTicket = upload.ticket;
+            uploads.pending.pop_front();
+        }
+    }
+
+    // Texture uploads elsewhere pass client pointers, which a bound unpack buffer would turn into offsets
+    bindBuffer(state, GL_PIXEL_UNPACK_BUFFER, 0);
+    uploads.uploadedSize += copiedSize;
+}
+
+void processUploads(Uploads &uploads, Resources &resources, GlState &state, GLsizeiptr budget) {
+    uploads.uploadedSize = 0;
+    reclaimStaging(uploads);
+    copyUploads(uploads, resources, state, budget);
+    fenceStaging(uploads);
+}
+
+void finishUploads(Uploads &uploads, Resources &resources, GlState &state) {
+    // Everything goes up now regardless of the budget, waiting on the GPU whenever the ring runs full
+    while (!uploads.pending.empty()) {
+        reclaimStaging(uploads);
+        copyUploads(uploads, resources, state, std::numeric_limits<GLsizeiptr>::max());
+        fenceStaging(uploads);
+
+        if (!uploads.pending.empty() && !uploads.retirements.empty()) {
+            while (glClientWaitSync(uploads.retirements.front().fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED);
+        }
+    }
+}
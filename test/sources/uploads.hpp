@@ -0,0 +1,62 @@
+#pragma once
+#include "resources.hpp"
+#include "state.hpp"
+#include <iostream>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <vector>
+#include <glad/glad.h>
+
+const GLsizeiptr UPLOAD_ALIGNMENT = 64;
+
+// One queued copy. Buffers can go up in pieces across frames, a texture level always goes in one piece
+struct PendingUpload {
+    ResourceHandle target;
+    bool isTexture = false;
+    GLintptr offset = 0;
+    int level = 0;
+    int layer = 0;
+    int width = 0;
+    int height = 0;
+    std::vector<char> data;
+    GLsizeiptr copiedSize = 0;
+    uint64_t ticket = 0;
+};
+
+// Staging bytes handed out during one frame, reusable once the GPU is past that frame's copies
+struct StagingRetirement {
+    GLsync fence;
+    GLsizeiptr size;
+};
+
+struct Uploads {
+    ResourceHandle staging;
+    GLsizeiptr stagingSize = 0;
+    bool isPersistent = false;
+    char* mapped = nullptr;
+    GLsizeiptr head = 0;
+    GLsizeiptr usedSize = 0;
+    GLsizeiptr frameSize = 0;
+    std::vector<StagingRetirement> retirements;
+    std::deque<PendingUpload> pending;
+    GLsizeiptr pendingSize = 0;
+    GLsizeiptr budget = (GLsizeiptr) 4 << 20;
+    GLsizeiptr uploadedSize = 0;
+    uint64_t queuedTicket = 0;
+    uint64_t issuedTicket = 0;
+};
+
+void createUploads(Uploads &uploads, Resources &resources, GLsizeiptr stagingSize);
+
+void destroyUploads(Uploads &uploads, Resources &resources);
+
+uint64_t queueBufferUpload(Uploads &uploads, ResourceHandle buffer, GLintptr offset, const void* data, GLsizeiptr size);
+
+uint64_t queueTextureUpload(Uploads &uploads, ResourceHandle texture, int level, int layer, int width, int height, const void* data);
+
+bool isUploadIssued(const Uploads &uploads, uint64_t ticket);
+
+void processUploads(Uploads &uploads, Resources &resources, GlState &state, GLsizeiptr budget);
+
+void finishUploads(Uploads &uploads, Resources &resources, GlState &state);